@@ -0,0 +1,43 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+
+//    operator new.  
+//   .cpp  #define ALLOC_COUNTER_IMPLEMENTATION.
+inline std::atomic<uint64_t>& heap_allocation_count() {
+    static std::atomic<uint64_t> count(0);
+    return count;
+}
+
+#endif
+
+#ifdef ALLOC_COUNTER_IMPLEMENTATION
+#ifndef ALLOC_COUNTER_IMPLEMENTED
+#define ALLOC_COUNTER_IMPLEMENTED
+
+#include <cstdlib>
+#include <new>
+
+void* operator new(std::size_t size) {
+    heap_allocation_count().fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    heap_allocation_count().fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#endif
+#endif
@@ -0,0 +1,333 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void grow(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void grow(const Aabb& b) {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+
+    //    ( SAH )
+    float area() const {
+        glm::vec3 e = max - min;
+        if (e.x < 0.0f) return 0.0f;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+//  AABB     m ( )
+inline Aabb transform_aabb(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& m) {
+    Aabb result;
+    result.min = result.max = glm::vec3(m[3]);
+    for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 3; row++) {
+            float a = m[col][row] * localMin[col];
+            float b = m[col][row] * localMax[col];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+struct BvhHit {
+    float t;
+    uint32_t item;
+    glm::vec3 normal;
+};
+
+//  AABB   .     SAH
+// (  ),    
+// update() + refit()  .    ,
+//       .
+class Bvh {
+public:
+    struct Node {
+        Aabb bounds;
+        uint32_t leftFirst;  // :   ( ), :  
+        uint32_t count;      // 0   
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> indices;
+    std::vector<Aabb> boxes;
+    std::vector<uint32_t> masks;
+
+    void clear() {
+        nodes.clear();
+        indices.clear();
+        boxes.clear();
+        masks.clear();
+        refitNeeded = false;
+    }
+
+    //    build(); mask    
+    uint32_t add(const Aabb& box, uint32_t mask) {
+        boxes.push_back(box);
+        masks.push_back(mask);
+        return (uint32_t)boxes.size() - 1;
+    }
+
+    void update(uint32_t item, const Aabb& box) {
+        boxes[item] = box;
+        refitNeeded = true;
+    }
+
+    void build() {
+        uint32_t count = (uint32_t)boxes.size();
+        indices.resize(count);
+        for (uint32_t i = 0; i < count; i++) indices[i] = i;
+
+        centers.resize(count);
+        for (uint32_t i = 0; i < count; i++) centers[i] = boxes[i].center();
+
+        nodes.clear();
+        nodes.reserve(count > 0 ? 2 * count - 1 : 1);
+        nodes.push_back({ Aabb(), 0, count });
+        update_bounds(0);
+        if (count > 0) subdivide(0);
+        refitNeeded = false;
+    }
+
+    //    :     
+    void refit() {
+        if (!refitNeeded || nodes.empty()) return;
+        for (size_t i = nodes.size(); i-- > 0;) {
+            Node& node = nodes[i];
+            if (node.count > 0) {
+                update_bounds((uint32_t)i);
+            }
+            else {
+                node.bounds = nodes[node.leftFirst].bounds;
+                node.bounds.grow(nodes[node.leftFirst + 1].bounds);
+            }
+        }
+        refitNeeded = false;
+    }
+
+    //    origin + dir * t, t  [0, maxT]
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, uint32_t mask, BvhHit& hit) const {
+        return cast(origin, dir, maxT, 0.0f, mask, hit);
+    }
+
+    //    origin  delta; t  [0, 1] -   .
+    //    AABB,   :    
+    //    ,     .
+    bool sphere_cast(const glm::vec3& origin, float radius, const glm::vec3& delta, uint32_t mask, BvhHit& hit) const {
+        return cast(origin, delta, 1.0f, radius, mask, hit);
+    }
+
+    //  ,    box: func(item)
+    template <typename Func>
+    void query(const Aabb& box, uint32_t mask, Func func) const {
+        if (nodes.empty() || boxes.empty()) return;
+
+        uint32_t stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!overlaps(node.bounds, box)) continue;
+
+            if (node.count > 0) {
+                for (uint32_t i = 0; i < node.count; i++) {
+                    uint32_t item = indices[node.leftFirst + i];
+                    if ((masks[item] & mask) && overlaps(boxes[item], box)) func(item);
+                }
+            }
+            else if (top + 2 <= STACK_SIZE) {
+                stack[top++] = node.leftFirst;
+                stack[top++] = node.leftFirst + 1;
+            }
+        }
+    }
+
+private:
+    static const int BINS = 8;
+    static const int STACK_SIZE = 64;
+
+    std::vector<glm::vec3> centers;
+    bool refitNeeded = false;
+
+    void update_bounds(uint32_t index) {
+        Node& node = nodes[index];
+        node.bounds = Aabb();
+        for (uint32_t i = 0; i < node.count; i++) {
+            node.bounds.grow(boxes[indices[node.leftFirst + i]]);
+        }
+    }
+
+    void subdivide(uint32_t index) {
+        uint32_t first = nodes[index].leftFirst;
+        uint32_t count = nodes[index].count;
+        if (count <= 2) return;
+
+        Aabb centerBounds;
+        for (uint32_t i = 0; i < count; i++) centerBounds.grow(centers[indices[first + i]]);
+
+        //    SAH      
+        int bestAxis = -1;
+        float bestSplit = 0.0f;
+        float bestCost = nodes[index].bounds.area() * count;
+
+        for (int axis = 0; axis < 3; axis++) {
+            float lo = centerBounds.min[axis];
+            float hi = centerBounds.max[axis];
+            if (hi <= lo) continue;
+
+            Aabb binBounds[BINS];
+            uint32_t binCount[BINS] = {};
+            float scale = BINS / (hi - lo);
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t item = indices[first + i];
+                int bin = std::min(BINS - 1, (int)((centers[item][axis] - lo) * scale));
+                binCount[bin]++;
+                binBounds[bin].grow(boxes[item]);
+            }
+
+            float leftArea[BINS - 1];
+            uint32_t leftCount[BINS - 1];
+            Aabb accumulated;
+            uint32_t sum = 0;
+            for (int i = 0; i < BINS - 1; i++) {
+                sum += binCount[i];
+                accumulated.grow(binBounds[i]);
+                leftCount[i] = sum;
+                leftArea[i] = accumulated.area();
+            }
+
+            accumulated = Aabb();
+            sum = 0;
+            for (int i = BINS - 1; i > 0; i--) {
+                sum += binCount[i];
+                accumulated.grow(binBounds[i]);
+                if (leftCount[i - 1] == 0 || sum == 0) continue;
+
+                float cost = leftArea[i - 1] * leftCount[i - 1] + accumulated.area() * sum;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = lo + i / scale;
+                }
+            }
+        }
+        if (bestAxis < 0) return;
+
+        uint32_t i = first;
+        uint32_t j = first + count - 1;
+        while (i <= j) {
+            if (centers[indices[i]][bestAxis] < bestSplit) {
+                i++;
+            }
+            else {
+                std::swap(indices[i], indices[j]);
+                if (j == 0) break;
+                j--;
+            }
+        }
+        uint32_t leftCount = i - first;
+        if (leftCount == 0 || leftCount == count) return;
+
+        uint32_t left = (uint32_t)nodes.size();
+        nodes.push_back({ Aabb(), first, leftCount });
+        nodes.push_back({ Aabb(), i, count - leftCount });
+        nodes[index].leftFirst = left;
+        nodes[index].count = 0;
+
+        update_bounds(left);
+        update_bounds(left + 1);
+        subdivide(left);
+        subdivide(left + 1);
+    }
+
+    static bool overlaps(const Aabb& a, const Aabb& b) {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+               a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    //    ,   radius; FLT_MAX  
+    static float slab(const Aabb& box, float radius, const glm::vec3& origin, const glm::vec3& invDir,
+        float maxT, int* axisOut = nullptr) {
+        glm::vec3 t0 = (box.min - glm::vec3(radius) - origin) * invDir;
+        glm::vec3 t1 = (box.max + glm::vec3(radius) - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+
+        int axis = 0;
+        float tEnter = tNear.x;
+        if (tNear.y > tEnter) { tEnter = tNear.y; axis = 1; }
+        if (tNear.z > tEnter) { tEnter = tNear.z; axis = 2; }
+        float tExit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+
+        if (tExit < tEnter || tExit < 0.0f || tEnter > maxT) return FLT_MAX;
+        if (axisOut) *axisOut = axis;
+        return tEnter;
+    }
+
+    bool cast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float radius, uint32_t mask, BvhHit& hit) const {
+        if (nodes.empty() || boxes.empty()) return false;
+
+        glm::vec3 invDir = glm::vec3(1.0f) / dir;
+        hit.t = maxT;
+        hit.item = 0xFFFFFFFFu;
+
+        uint32_t stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (slab(node.bounds, radius, origin, invDir, hit.t) == FLT_MAX) continue;
+
+            if (node.count > 0) {
+                for (uint32_t i = 0; i < node.count; i++) {
+                    uint32_t item = indices[node.leftFirst + i];
+                    if (!(masks[item] & mask)) continue;
+
+                    int axis = 0;
+                    float t = slab(boxes[item], radius, origin, invDir, hit.t, &axis);
+                    //      
+                    if (t == FLT_MAX || t < 0.0f || t > hit.t) continue;
+
+                    hit.t = t;
+                    hit.item = item;
+                    hit.normal = glm::vec3(0.0f);
+                    hit.normal[axis] = dir[axis] > 0.0f ? -1.0f : 1.0f;
+                }
+                continue;
+            }
+
+            //    ,    hit.t
+            uint32_t near = node.leftFirst;
+            uint32_t far = node.leftFirst + 1;
+            float tNear = slab(nodes[near].bounds, radius, origin, invDir, hit.t);
+            float tFar = slab(nodes[far].bounds, radius, origin, invDir, hit.t);
+            if (tNear > tFar) {
+                std::swap(near, far);
+                std::swap(tNear, tFar);
+            }
+            if (tFar != FLT_MAX && top < STACK_SIZE) stack[top++] = far;
+            if (tNear != FLT_MAX && top < STACK_SIZE) stack[top++] = near;
+        }
+        return hit.item != 0xFFFFFFFFu;
+    }
+};
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stb_image_write.h"
+
+//     . glReadPixels   PBO 
+//    ,    PBOS - 1 ,
+//    GPU   ( fence).  
+//        : PNG- 
+//    RGBA-.   -   ,
+//   GL  .
+class FrameCapture {
+public:
+    enum Format { PNG_SEQUENCE, RAW_VIDEO };
+
+    static const int PBOS = 3;
+
+    size_t maxQueuedFrames = 16;   //  ;    
+
+    //    ,    
+    std::atomic<int> capturedFrames{ 0 };
+    std::atomic<int> droppedFrames{ 0 };
+    double readbackMs = 0.0;   //      
+
+    ~FrameCapture() { stop(); }
+
+    bool active() const { return running; }
+
+    // prefix -   : prefix_000000.png  prefix.rgba
+    bool start(int frameWidth, int frameHeight, Format captureFormat, const std::string& capturePrefix) {
+        if (running || frameWidth <= 0 || frameHeight <= 0) return false;
+        width = frameWidth;
+        height = frameHeight;
+        format = captureFormat;
+        prefix = capturePrefix;
+        frameBytes = (size_t)width * height * 4;
+
+        if (format == RAW_VIDEO) {
+            rawFile = fopen((prefix + ".rgba").c_str(), "wb");
+            if (!rawFile) {
+                std::cout << "Failed to open " << prefix << ".rgba" << std::endl;
+                return false;
+            }
+        }
+        else {
+            //   stb:    
+            stbi_flip_vertically_on_write(1);
+            stbi_write_png_compression_level = 1;   //  ,   
+        }
+
+        glGenBuffers(PBOS, pbos);
+        for (int i = 0; i < PBOS; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        capturedFrames = 0;
+        droppedFrames = 0;
+        nextFrame = 0;
+        nextSequence = 0;
+        dropRun = 0;
+        current = 0;
+        running = true;
+        encoder = std::thread([this]() { encode_loop(); });
+
+        std::cout << "Capture started: " << width << "x" << height << " "
+            << (format == RAW_VIDEO ? "raw RGBA video" : "PNG sequence") << " -> " << prefix << std::endl;
+        return true;
+    }
+
+    //  ,     
+    void stop() {
+        if (!running) return;
+
+        for (int i = 0; i < PBOS; i++) {
+            int index = (current + i) % PBOS;
+            if (fences[index]) collect(index, true);
+        }
+        report_drops();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        condition.notify_all();
+        encoder.join();
+
+        glDeleteBuffers(PBOS, pbos);
+        for (int i = 0; i < PBOS; i++) pbos[i] = 0;
+        freeFrames.clear();
+
+        if (rawFile) {
+            fclose(rawFile);
+            rawFile = nullptr;
+            //     ,    glReadPixels
+            std::cout << "Encode with: ffmpeg -f rawvideo -pixel_format rgba -video_size " << width << "x" << height
+                << " -framerate 60 -i " << prefix << ".rgba -vf vflip " << prefix << ".mp4" << std::endl;
+        }
+        std::cout << "Capture stopped: " << capturedFrames << " frames written, " << droppedFrames << " dropped" << std::endl;
+    }
+
+    //     ,  SwapBuffers.  
+    //  -  :     .
+    void capture(int frameWidth, int frameHeight) {
+        if (!running) return;
+        if (frameWidth != width || frameHeight != height) {
+            std::cout << "Window resized, capture stopped" << std::endl;
+            stop();
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        //   -  ,  
+        for (int i = 0; i < PBOS; i++) {
+            int index = (current + i) % PBOS;
+            if (!fences[index]) continue;
+            GLenum status = glClientWaitSync(fences[index], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+            collect(index, false);
+        }
+        //    : GPU   PBOS , 
+        if (fences[current]) collect(current, true);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[current]);
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frameNumbers[current] = nextFrame++;
+        current = (current + 1) % PBOS;
+
+        readbackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    struct Frame {
+        int tick;   //      ,   
+        std::vector<unsigned char> pixels;
+    };
+
+    int width = 0;
+    int height = 0;
+    Format format = PNG_SEQUENCE;
+    std::string prefix;
+    size_t frameBytes = 0;
+    FILE* rawFile = nullptr;
+
+    unsigned int pbos[PBOS] = {};
+    GLsync fences[PBOS] = {};
+    int frameNumbers[PBOS] = {};
+    int current = 0;
+    int nextFrame = 0;
+    //   ;       
+    //  ,   PNG-  
+    int nextSequence = 0;
+    int dropRun = 0;
+    int firstDropped = 0;
+
+    std::thread encoder;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Frame> encodeQueue;
+    std::vector<std::vector<unsigned char>> freeFrames;   //     
+    bool running = false;
+
+    //  PBO   ; wait -  fence,    
+    void collect(int index, bool wait) {
+        if (wait) glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(fences[index]);
+        fences[index] = 0;
+
+        Frame frame;
+        frame.tick = frameNumbers[index];
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (encodeQueue.size() >= maxQueuedFrames) {
+                note_drop(frame.tick);
+                return;
+            }
+            if (!freeFrames.empty()) {
+                frame.pixels.swap(freeFrames.back());
+                freeFrames.pop_back();
+            }
+        }
+        frame.pixels.resize(frameBytes);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index]);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+        if (data) {
+            memcpy(frame.pixels.data(), data, frameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!data) {
+            note_drop(frame.tick);
+            return;
+        }
+
+        report_drops();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            encodeQueue.push_back(std::move(frame));
+        }
+        condition.notify_one();
+    }
+
+    //          
+    void note_drop(int tick) {
+        droppedFrames++;
+        if (dropRun == 0) firstDropped = tick;
+        dropRun++;
+    }
+
+    void report_drops() {
+        if (dropRun == 0) return;
+        std::cout << "Capture: " << dropRun << " frame(s) dropped at ticks " << firstDropped << "-"
+            << firstDropped + dropRun - 1 << " (encoder queue full or PBO map failed)" << std::endl;
+        dropRun = 0;
+    }
+
+    //       stop()
+    void encode_loop() {
+        while (true) {
+            Frame frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return !running || !encodeQueue.empty(); });
+                if (encodeQueue.empty()) return;
+                frame = std::move(encodeQueue.front());
+                encodeQueue.pop_front();
+            }
+
+            bool written;
+            if (format == RAW_VIDEO) {
+                size_t bytes = fwrite(frame.pixels.data(), 1, frameBytes, rawFile);
+                written = bytes == frameBytes;
+                if (!written) {
+                    //   ,     
+                    clearerr(rawFile);
+                    fseek(rawFile, -(long)bytes, SEEK_CUR);
+                }
+            }
+            else {
+                char path[32];
+                snprintf(path, sizeof(path), "_%06d.png", nextSequence);
+                written = stbi_write_png((prefix + path).c_str(), width, height, 4, frame.pixels.data(), width * 4) != 0;
+            }
+            if (written) nextSequence++;
+            else std::cout << "Capture: frame " << frame.tick << " dropped, write failed" << std::endl;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (written) capturedFrames++;
+            else droppedFrames++;
+            freeFrames.push_back(std::move(frame.pixels));
+        }
+    }
+};
+
+#endif
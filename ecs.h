@@ -0,0 +1,194 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+// :   +  (    )
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+
+    bool operator==(const Entity& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+const uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+const Entity NULL_ENTITY = { INVALID_INDEX, 0 };
+
+inline uint32_t next_component_id() {
+    static uint32_t counter = 0;
+    return counter++;
+}
+
+template <typename T>
+uint32_t component_id() {
+    static uint32_t id = next_component_id();
+    return id;
+}
+
+class ComponentArrayBase {
+public:
+    virtual ~ComponentArrayBase() {}
+    virtual bool has(Entity e) const = 0;
+    virtual void remove(Entity e) = 0;
+    virtual void clear() = 0;
+};
+
+//  :     ,
+// sparse[ ] ->    
+template <typename T>
+class ComponentArray : public ComponentArrayBase {
+public:
+    std::vector<T> dense;
+    std::vector<Entity> entities;
+    std::vector<uint32_t> sparse;
+
+    size_t size() const { return dense.size(); }
+
+    void reserve(size_t count) {
+        dense.reserve(count);
+        entities.reserve(count);
+    }
+
+    bool has(Entity e) const override {
+        return e.index < sparse.size() && sparse[e.index] != INVALID_INDEX &&
+            entities[sparse[e.index]] == e;
+    }
+
+    T& add(Entity e, const T& value) {
+        if (e.index >= sparse.size()) {
+            sparse.resize(e.index + 1, INVALID_INDEX);
+        }
+        if (sparse[e.index] != INVALID_INDEX) {
+            dense[sparse[e.index]] = value;
+            entities[sparse[e.index]] = e;
+            return dense[sparse[e.index]];
+        }
+        sparse[e.index] = (uint32_t)dense.size();
+        dense.push_back(value);
+        entities.push_back(e);
+        return dense.back();
+    }
+
+    //     
+    void remove(Entity e) override {
+        if (!has(e)) return;
+        uint32_t slot = sparse[e.index];
+        uint32_t last = (uint32_t)dense.size() - 1;
+        if (slot != last) {
+            dense[slot] = dense[last];
+            entities[slot] = entities[last];
+            sparse[entities[slot].index] = slot;
+        }
+        dense.pop_back();
+        entities.pop_back();
+        sparse[e.index] = INVALID_INDEX;
+    }
+
+    void clear() override {
+        dense.clear();
+        entities.clear();
+        sparse.clear();
+    }
+
+    T& get(Entity e) { return dense[sparse[e.index]]; }
+    const T& get(Entity e) const { return dense[sparse[e.index]]; }
+
+    T* tryGet(Entity e) { return has(e) ? &dense[sparse[e.index]] : nullptr; }
+};
+
+class Registry {
+public:
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeList;
+
+    Entity create() {
+        if (!freeList.empty()) {
+            uint32_t index = freeList.back();
+            freeList.pop_back();
+            return { index, generations[index] };
+        }
+        generations.push_back(0);
+        return { (uint32_t)generations.size() - 1, 0 };
+    }
+
+    bool alive(Entity e) const {
+        return e.index < generations.size() && generations[e.index] == e.generation;
+    }
+
+    void destroy(Entity e) {
+        if (!alive(e)) return;
+        for (auto& pool : pools) {
+            if (pool) pool->remove(e);
+        }
+        generations[e.index]++;
+        freeList.push_back(e.index);
+    }
+
+    //   :      .
+    //    freeList ,  create()    .
+    void clear() {
+        for (auto& pool : pools) {
+            if (pool) pool->clear();
+        }
+        freeList.clear();
+        for (uint32_t index = (uint32_t)generations.size(); index-- > 0;) {
+            generations[index]++;
+            freeList.push_back(index);
+        }
+    }
+
+    template <typename T>
+    ComponentArray<T>& storage() {
+        uint32_t id = component_id<T>();
+        if (id >= pools.size()) pools.resize(id + 1);
+        if (!pools[id]) pools[id].reset(new ComponentArray<T>());
+        return *static_cast<ComponentArray<T>*>(pools[id].get());
+    }
+
+    template <typename T>
+    T& add(Entity e, const T& value) { return storage<T>().add(e, value); }
+
+    template <typename T>
+    void remove(Entity e) { storage<T>().remove(e); }
+
+    template <typename T>
+    bool has(Entity e) { return storage<T>().has(e); }
+
+    template <typename T>
+    T& get(Entity e) { return storage<T>().get(e); }
+
+    template <typename T>
+    T* tryGet(Entity e) { return storage<T>().tryGet(e); }
+
+    template <typename T>
+    size_t count() { return storage<T>().size(); }
+
+    //  ,      .
+    //       ,  
+    //     .
+    template <typename First, typename... Rest, typename Func>
+    void each(Func func) {
+        ComponentArray<First>& first = storage<First>();
+        for (size_t i = 0; i < first.size(); i++) {
+            Entity e = first.entities[i];
+            if (!has_all<Rest...>(e)) continue;
+            func(e, first.dense[i], storage<Rest>().get(e)...);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<ComponentArrayBase>> pools;
+
+    template <typename... Ts>
+    bool has_all(Entity e) {
+        (void)e;
+        return (storage<Ts>().has(e) && ...);
+    }
+};
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "bvh.h"
+#include "ecs.h"
+#include "jobs.h"
+#include "rng.h"
+
+//    .     
+// (SoA),   parallel_for   .  
+//   ,      , 
+//      ;    
+//  .  - sphere_cast    BVH ,
+//     (refit)   .
+class Fleet {
+public:
+    static constexpr int NO_TARGET = -1;
+    static const int REBUILD_INTERVAL = 30;
+    static const int MAX_NEIGHBOURS = 8;
+
+    float cruiseSpeed = 35.0f;
+    float maxAcceleration = 30.0f;
+    float cruiseHeight = 60.0f;
+    float heightSpread = 60.0f;   //  ,   
+    float shipRadius = 12.0f;
+    float lookAhead = 1.5f;       //    
+    float arriveRadius = 40.0f;   //    
+    float dropRadius = 3.0f;
+    float reclaimDelay = 4.0f;    //     ,   
+    float worldHalfExtent = 200.0f;
+
+    std::vector<Entity> entities;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> velocities;
+    std::vector<float> headings;      //  Transform::rotation
+    std::vector<float> altitudes;
+    std::vector<int> targets;         //    NO_TARGET
+    std::vector<glm::vec3> waypoints;
+    std::vector<Rng> rngs;
+    std::vector<uint8_t> dropFlags;   //  steer(),  take_drops()
+    std::vector<int> claimedBy;       // ,  
+    std::vector<float> reclaimTimers;
+
+    size_t avoidances = 0;            //    
+
+    size_t size() const { return positions.size(); }
+
+    void clear() {
+        entities.clear();
+        positions.clear();
+        velocities.clear();
+        headings.clear();
+        altitudes.clear();
+        targets.clear();
+        waypoints.clear();
+        rngs.clear();
+        dropFlags.clear();
+        claimedBy.clear();
+        reclaimTimers.clear();
+        bvh.clear();
+    }
+
+    //    , position.y  
+    void add(Entity e, glm::vec3 position, float heading, uint64_t seed) {
+        Rng rng(seed);
+        position.y = cruiseHeight + rng.range(0.0f, heightSpread);
+        entities.push_back(e);
+        positions.push_back(position);
+        velocities.push_back(glm::vec3(0.0f));
+        headings.push_back(heading);
+        altitudes.push_back(position.y);
+        targets.push_back(NO_TARGET);
+        waypoints.push_back(random_waypoint(rng));
+        rngs.push_back(rng);
+        dropFlags.push_back(0);
+        bvh.add(ship_box(position), 1);
+    }
+
+    //    
+    void build() {
+        bvh.build();
+        framesSinceRebuild = 0;
+    }
+
+    //    ( ): BVH   
+    void rebuild() {
+        bvh.clear();
+        dropFlags.assign(size(), 0);
+        for (size_t i = 0; i < size(); i++) bvh.add(ship_box(positions[i]), 1);
+        build();
+    }
+
+    // :    . houseOpen[h] -
+    //    
+    void assign_targets(float deltaTime, const std::vector<glm::vec3>& housePositions,
+        const std::vector<uint8_t>& houseOpen) {
+        if (claimedBy.size() != housePositions.size()) {
+            claimedBy.assign(housePositions.size(), NO_TARGET);
+            reclaimTimers.assign(housePositions.size(), 0.0f);
+        }
+        for (size_t h = 0; h < housePositions.size(); h++) {
+            reclaimTimers[h] = std::max(0.0f, reclaimTimers[h] - deltaTime);
+            //   -  (  )
+            if (!houseOpen[h] && claimedBy[h] != NO_TARGET) {
+                targets[claimedBy[h]] = NO_TARGET;
+                claimedBy[h] = NO_TARGET;
+            }
+        }
+
+        for (size_t h = 0; h < housePositions.size(); h++) {
+            if (!houseOpen[h] || claimedBy[h] != NO_TARGET || reclaimTimers[h] > 0.0f) continue;
+
+            //   
+            int best = NO_TARGET;
+            float bestDistance = 1e30f;
+            for (size_t i = 0; i < size(); i++) {
+                if (targets[i] != NO_TARGET) continue;
+                glm::vec3 d = housePositions[h] - positions[i];
+                float distance = d.x * d.x + d.z * d.z;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = (int)i;
+                }
+            }
+            if (best == NO_TARGET) break;
+            targets[best] = (int)h;
+            claimedBy[h] = best;
+        }
+    }
+
+    void steer(JobSystem& jobs, float deltaTime, const std::vector<glm::vec3>& housePositions) {
+        update_bvh();
+
+        std::atomic<size_t> avoided{ 0 };
+        jobs.parallel_for((uint32_t)size(), 128, [&](uint32_t begin, uint32_t end) {
+            size_t localAvoided = 0;
+            for (uint32_t i = begin; i < end; i++) {
+                glm::vec3 position = positions[i];
+                glm::vec3 velocity = velocities[i];
+
+                glm::vec3 goal;
+                if (targets[i] != NO_TARGET) {
+                    goal = housePositions[targets[i]];
+                }
+                else {
+                    glm::vec3 d = waypoints[i] - position;
+                    if (d.x * d.x + d.z * d.z < 15.0f * 15.0f) waypoints[i] = random_waypoint(rngs[i]);
+                    goal = waypoints[i];
+                }
+                goal.y = altitudes[i];
+
+                // :    
+                glm::vec3 toGoal = goal - position;
+                float distance = glm::length(toGoal);
+                glm::vec3 desired(0.0f);
+                if (distance > 0.01f) {
+                    desired = toGoal / distance * cruiseSpeed * std::min(1.0f, distance / arriveRadius);
+                }
+
+                //     : sphere_cast
+                //   ,   
+                glm::vec3 separation(0.0f);
+                int neighbours = 0;
+                bvh.query(ship_box(position), 1, [&](uint32_t j) {
+                    if (j == i || neighbours >= MAX_NEIGHBOURS) return;
+                    //   BVH -   , positions[j]    
+                    glm::vec3 d = position - bvh.boxes[j].center();
+                    float length = glm::length(d);
+                    if (length < 2.0f * shipRadius && length > 1e-3f) {
+                        separation += d / length * (1.0f - length / (2.0f * shipRadius));
+                        neighbours++;
+                    }
+                });
+                desired += separation * cruiseSpeed * 2.0f;
+
+                // :     ,    
+                BvhHit hit;
+                if (glm::length(velocity) > 0.5f && bvh.sphere_cast(position, shipRadius, velocity * lookAhead, 1, hit)) {
+                    glm::vec3 away = hit.normal;
+                    if (away.y != 0.0f) away = glm::vec3(0.0f, away.y, 0.0f);
+                    //  :    ,   
+                    glm::vec3 side = glm::normalize(glm::vec3(-velocity.z, 0.0f, velocity.x) + glm::vec3(0.0f, 1e-4f, 0.0f));
+                    desired += (away + side * 0.5f) * cruiseSpeed * (1.0f - hit.t) * 2.0f;
+                    localAvoided++;
+                }
+
+                glm::vec3 steering = desired - velocity;
+                float maxDelta = maxAcceleration * deltaTime;
+                float steeringLength = glm::length(steering);
+                if (steeringLength > maxDelta) steering *= maxDelta / steeringLength;
+                velocity += steering;
+
+                position += velocity * deltaTime;
+                position.x = glm::clamp(position.x, -worldHalfExtent, worldHalfExtent);
+                position.z = glm::clamp(position.z, -worldHalfExtent, worldHalfExtent);
+
+                if (velocity.x * velocity.x + velocity.z * velocity.z > 1.0f) {
+                    headings[i] = atan2f(-velocity.x, -velocity.z);
+                }
+
+                if (targets[i] != NO_TARGET) {
+                    glm::vec3 d = housePositions[targets[i]] - position;
+                    if (d.x * d.x + d.z * d.z < dropRadius * dropRadius) dropFlags[i] = 1;
+                }
+
+                positions[i] = position;
+                velocities[i] = velocity;
+            }
+            avoided += localAvoided;
+        });
+        avoidances = avoided.load();
+    }
+
+    //   steer(): spawn()   
+    template <typename Func>
+    void take_drops(Func spawn) {
+        for (size_t i = 0; i < size(); i++) {
+            if (!dropFlags[i]) continue;
+            dropFlags[i] = 0;
+
+            int h = targets[i];
+            if (h == NO_TARGET) continue;
+            spawn(positions[i]);
+            claimedBy[h] = NO_TARGET;
+            reclaimTimers[h] = reclaimDelay;
+            targets[i] = NO_TARGET;
+        }
+    }
+
+    int busy_ships() const {
+        int busy = 0;
+        for (int t : targets) {
+            if (t != NO_TARGET) busy++;
+        }
+        return busy;
+    }
+
+private:
+    Bvh bvh;
+    int framesSinceRebuild = 0;
+
+    Aabb ship_box(const glm::vec3& position) const {
+        Aabb box;
+        box.min = position - glm::vec3(shipRadius);
+        box.max = position + glm::vec3(shipRadius);
+        return box;
+    }
+
+    glm::vec3 random_waypoint(Rng& rng) const {
+        float margin = worldHalfExtent * 0.9f;
+        return glm::vec3(rng.range(-margin, margin), 0.0f, rng.range(-margin, margin));
+    }
+
+    //    ;  refit  , 
+    //   
+    void update_bvh() {
+        for (size_t i = 0; i < size(); i++) bvh.update((uint32_t)i, ship_box(positions[i]));
+        if (++framesSinceRebuild >= REBUILD_INTERVAL) {
+            bvh.build();
+            framesSinceRebuild = 0;
+        }
+        else {
+            bvh.refit();
+        }
+    }
+};
+
+#endif
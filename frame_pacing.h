@@ -0,0 +1,128 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <thread>
+
+//     . : vsync,   
+//  targetFps .    pacer , 
+//   GPU    maxQueuedFrames , - 
+//         . 
+// " -    GPU"    GL_TIMESTAMP  
+// SwapBuffers: ,  fence ,    .
+//  GPU   glfwGetTime   ,   .
+class FramePacer {
+public:
+    enum Mode { VSYNC, UNCAPPED, LIMITED, MODE_COUNT };
+
+    static const int FENCES = 4;
+
+    Mode mode = VSYNC;
+    double targetFps = 120.0;
+    int maxQueuedFrames = 1;
+
+    double latencyMs = 0.0;   //   ,   GPU
+    double waitMs = 0.0;      //   wait()  
+
+    void set_mode(Mode newMode) {
+        mode = newMode;
+        glfwSwapInterval(mode == VSYNC ? 1 : 0);
+        nextFrame = glfwGetTime();
+    }
+
+    const char* mode_name() const {
+        static const char* names[MODE_COUNT] = { "vsync", "uncapped", "limited" };
+        return names[mode];
+    }
+
+    //  ,    
+    void wait() {
+        double start = glfwGetTime();
+
+        //  :  ,  maxQueuedFrames 
+        int queued = 0;
+        for (int i = 0; i < FENCES; i++) {
+            if (fences[i]) queued++;
+        }
+        while (queued > maxQueuedFrames) {
+            int oldest = (current + FENCES - queued) % FENCES;
+            glClientWaitSync(fences[oldest], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+            poll();
+            if (fences[oldest]) break;  //  -   
+            queued--;
+        }
+
+        if (mode == LIMITED) {
+            double period = 1.0 / targetFps;
+            //   ,   : sleep 
+            double now = glfwGetTime();
+            if (nextFrame - now > 0.002) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(nextFrame - now - 0.002));
+            }
+            while (glfwGetTime() < nextFrame) {}
+            now = glfwGetTime();
+            //       
+            nextFrame = nextFrame + period < now ? now + period : nextFrame + period;
+        }
+
+        waitMs = (glfwGetTime() - start) * 1000.0;
+    }
+
+    //    ,   
+    void input_sampled() { inputTime = glfwGetTime(); }
+
+    //   SwapBuffers
+    void frame_submitted() {
+        if (!queries[0]) glGenQueries(FENCES, queries);
+        poll();
+        if (fences[current]) glDeleteSync(fences[current]);
+
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        clockOffsets[current] = glfwGetTime() - gpuNow / 1e9;
+        //   fence:  fence ,    
+        glQueryCounter(queries[current], GL_TIMESTAMP);
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        fenceInputTimes[current] = inputTime;
+        current = (current + 1) % FENCES;
+    }
+
+    void destroy() {
+        for (int i = 0; i < FENCES; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        if (queries[0]) glDeleteQueries(FENCES, queries);
+        for (int i = 0; i < FENCES; i++) queries[i] = 0;
+    }
+
+private:
+    GLsync fences[FENCES] = {};
+    unsigned int queries[FENCES] = {};
+    double fenceInputTimes[FENCES] = {};
+    double clockOffsets[FENCES] = {};   // glfwGetTime() -  GPU,  
+    int current = 0;
+    double inputTime = 0.0;
+    double nextFrame = 0.0;
+
+    //  ,    
+    void poll() {
+        for (int i = 0; i < FENCES; i++) {
+            int index = (current + i) % FENCES;
+            if (!fences[index]) continue;
+
+            GLenum status = glClientWaitSync(fences[index], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+            GLuint64 finished = 0;
+            glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &finished);
+            latencyMs = (clockOffsets[index] + finished / 1e9 - fenceInputTimes[index]) * 1000.0;
+            glDeleteSync(fences[index]);
+            fences[index] = 0;
+        }
+    }
+};
+
+#endif
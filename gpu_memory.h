@@ -0,0 +1,162 @@
+#ifndef GPU_MEMORY_H
+#define GPU_MEMORY_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//  :       ,
+//  (  , "vertices"  ..),   .  -
+// : RGB   4   ,    .
+//      .
+class GpuMemory {
+public:
+    enum Kind { BUFFER, TEXTURE, RENDERBUFFER, KIND_COUNT };
+
+    struct Resource {
+        Kind kind;
+        unsigned int id;        // 0 -   
+        std::string owner;
+        std::string label;
+        const char* format;
+        size_t bytes;
+        uint64_t contentHash;   // 0 -  
+    };
+
+    size_t budgetBytes = 256u << 20;
+    size_t totalBytes = 0;
+
+    //    bytes,    
+    bool fits(size_t bytes) const { return totalBytes + bytes <= budgetBytes; }
+
+    //       
+    void track(Kind kind, unsigned int id, const std::string& owner, const std::string& label,
+        const char* format, size_t bytes, uint64_t contentHash = 0) {
+        auto it = index.find(key(kind, id, owner, label));
+        if (it != index.end()) {
+            Resource& r = resources[it->second];
+            totalBytes = totalBytes - r.bytes + bytes;
+            r.owner = owner;
+            r.format = format;
+            r.bytes = bytes;
+            r.contentHash = contentHash;
+            return;
+        }
+        index[key(kind, id, owner, label)] = resources.size();
+        resources.push_back({ kind, id, owner, label, format, bytes, contentHash });
+        totalBytes += bytes;
+
+        if (totalBytes > budgetBytes && !overBudgetReported) {
+            std::cout << "Warning: GPU memory budget exceeded by " << owner << " " << label
+                << " (" << mb(totalBytes) << " of " << mb(budgetBytes) << " MB)" << std::endl;
+            overBudgetReported = true;
+        }
+    }
+
+    void untrack(Kind kind, unsigned int id, const std::string& owner = "", const std::string& label = "") {
+        auto it = index.find(key(kind, id, owner, label));
+        if (it == index.end()) return;
+
+        size_t slot = it->second;
+        totalBytes -= resources[slot].bytes;
+        index.erase(it);
+        if (slot != resources.size() - 1) {
+            resources[slot] = resources.back();
+            const Resource& moved = resources[slot];
+            index[key(moved.kind, moved.id, moved.owner, moved.label)] = slot;
+        }
+        resources.pop_back();
+    }
+
+    size_t bytes_of(Kind kind) const {
+        size_t sum = 0;
+        for (const Resource& r : resources) {
+            if (r.kind == kind) sum += r.bytes;
+        }
+        return sum;
+    }
+
+    void report() const {
+        static const char* kindNames[KIND_COUNT] = { "buffer", "texture", "renderbuffer" };
+
+        std::vector<const Resource*> sorted;
+        for (const Resource& r : resources) sorted.push_back(&r);
+        std::sort(sorted.begin(), sorted.end(), [](const Resource* a, const Resource* b) {
+            return a->owner != b->owner ? a->owner < b->owner : a->bytes > b->bytes;
+        });
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "--- GPU memory: " << mb(totalBytes) << " MB of " << mb(budgetBytes)
+            << " MB budget (" << 100.0 * totalBytes / budgetBytes << "%) ---" << std::endl;
+        for (const Resource* r : sorted) {
+            std::cout << "  " << std::setw(18) << std::left << r->owner
+                << std::setw(13) << kindNames[r->kind]
+                << std::setw(26) << r->label
+                << std::setw(9) << r->format << std::right
+                << std::setw(10) << r->bytes / 1024.0 << " KB" << std::endl;
+        }
+        for (int k = 0; k < KIND_COUNT; k++) {
+            std::cout << "  total " << std::setw(14) << std::left << kindNames[k] << std::right
+                << mb(bytes_of((Kind)k)) << " MB" << std::endl;
+        }
+
+        // :     id
+        std::unordered_map<uint64_t, std::vector<const Resource*>> groups;
+        for (const Resource& r : resources) {
+            if (r.contentHash != 0) groups[r.contentHash].push_back(&r);
+        }
+        size_t wasted = 0;
+        for (const auto& group : groups) {
+            if (group.second.size() < 2) continue;
+            const Resource* first = group.second[0];
+            std::cout << "  duplicate x" << group.second.size() << ": " << first->label << " (";
+            for (size_t i = 0; i < group.second.size(); i++) {
+                std::cout << (i ? ", " : "") << group.second[i]->owner;
+            }
+            std::cout << ")" << std::endl;
+            wasted += first->bytes * (group.second.size() - 1);
+        }
+        if (wasted > 0) std::cout << "  wasted on duplicates " << mb(wasted) << " MB" << std::endl;
+    }
+
+    //      
+    static size_t texture_bytes(int width, int height, int bytesPerPixel, bool mipmapped) {
+        size_t bytes = 0;
+        while (true) {
+            bytes += (size_t)width * height * bytesPerPixel;
+            if (!mipmapped || (width == 1 && height == 1)) break;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return bytes;
+    }
+
+    // FNV-1a  ,   
+    static uint64_t hash(const void* data, size_t bytes) {
+        const unsigned char* p = (const unsigned char*)data;
+        uint64_t h = 1469598103934665603ull;
+        for (size_t i = 0; i < bytes; i++) h = (h ^ p[i]) * 1099511628211ull;
+        return h == 0 ? 1 : h;
+    }
+
+    static double mb(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+private:
+    std::vector<Resource> resources;
+    std::unordered_map<std::string, size_t> index;
+    bool overBudgetReported = false;
+
+    //   (id 0)    
+    static std::string key(Kind kind, unsigned int id, const std::string& owner, const std::string& label) {
+        std::string k = std::to_string((int)kind) + ":" + std::to_string(id);
+        if (id == 0) k += ":" + owner + ":" + label;
+        return k;
+    }
+};
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// :    [begin, end)   
+struct Job {
+    void (*func)(void* data, uint32_t begin, uint32_t end);
+    void* data;
+    uint32_t begin;
+    uint32_t end;
+    std::atomic<int>* counter;
+};
+
+//    :     (LIFO),
+//     (FIFO)
+class WorkQueue {
+public:
+    static const uint32_t CAPACITY = 1024;
+
+    bool push(const Job& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail - head >= CAPACITY) return false;
+        jobs[tail % CAPACITY] = job;
+        tail++;
+        return true;
+    }
+
+    bool pop(Job& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail == head) return false;
+        tail--;
+        job = jobs[tail % CAPACITY];
+        return true;
+    }
+
+    bool steal(Job& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail == head) return false;
+        job = jobs[head % CAPACITY];
+        head++;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    Job jobs[CAPACITY];
+    uint32_t head = 0;
+    uint32_t tail = 0;
+};
+
+inline int& current_worker_index() {
+    static thread_local int index = 0;
+    return index;
+}
+
+//    . ,  start(), 
+//  0   ,    .
+class JobSystem {
+public:
+    static const int MAX_WORKERS = 64;
+
+    struct WorkerStats {
+        std::atomic<uint64_t> busyNs{ 0 };
+        std::atomic<uint32_t> jobs{ 0 };
+        std::atomic<uint32_t> steals{ 0 };
+    };
+
+    WorkerStats stats[MAX_WORKERS];
+
+    ~JobSystem() { stop(); }
+
+    void start(unsigned threadCount = 0) {
+        if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+        if (threadCount > (unsigned)MAX_WORKERS) threadCount = MAX_WORKERS;
+
+        workerCount = (int)threadCount;
+        queues = std::vector<WorkQueue>(workerCount);
+        running = true;
+        current_worker_index() = 0;
+        for (int i = 1; i < workerCount; i++) {
+            threads.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    void stop() {
+        if (!running) return;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running = false;
+        }
+        sleepCondition.notify_all();
+        for (auto& t : threads) t.join();
+        threads.clear();
+    }
+
+    int worker_count() const { return workerCount; }
+
+    void submit(const Job& job) {
+        job.counter->fetch_add(1);
+        if (!queues[current_worker_index()].push(job)) {
+            execute(job);
+            return;
+        }
+        pendingJobs.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCondition.notify_one();
+    }
+
+    //      
+    void wait(std::atomic<int>& counter) {
+        while (counter.load() > 0) {
+            Job job;
+            if (find_job(current_worker_index(), job)) {
+                execute(job);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    //  [0, count)    grain    
+    template <typename Func>
+    void parallel_for(uint32_t count, uint32_t grain, Func&& func) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        if (workerCount <= 1 || count <= grain) {
+            func(0u, count);
+            return;
+        }
+
+        std::atomic<int> counter(0);
+        Job job;
+        job.func = [](void* data, uint32_t begin, uint32_t end) {
+            (*static_cast<typename std::remove_reference<Func>::type*>(data))(begin, end);
+        };
+        job.data = (void*)&func;
+        job.counter = &counter;
+
+        for (uint32_t begin = 0; begin < count; begin += grain) {
+            job.begin = begin;
+            job.end = begin + grain < count ? begin + grain : count;
+            submit(job);
+        }
+        wait(counter);
+    }
+
+    void reset_stats() {
+        for (int i = 0; i < workerCount; i++) {
+            stats[i].busyNs = 0;
+            stats[i].jobs = 0;
+            stats[i].steals = 0;
+        }
+    }
+
+private:
+    int workerCount = 1;
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> threads;
+    std::atomic<int> pendingJobs{ 0 };
+    bool running = false;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    bool find_job(int index, Job& job) {
+        if (queues[index].pop(job)) {
+            pendingJobs.fetch_sub(1);
+            return true;
+        }
+        for (int k = 1; k < workerCount; k++) {
+            int victim = (index + k) % workerCount;
+            if (queues[victim].steal(job)) {
+                pendingJobs.fetch_sub(1);
+                stats[index].steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(const Job& job) {
+        //   ( wait  )    
+        static thread_local int depth = 0;
+        int index = current_worker_index();
+        auto start = std::chrono::steady_clock::now();
+
+        depth++;
+        job.func(job.data, job.begin, job.end);
+        depth--;
+
+        if (depth == 0) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            stats[index].busyNs.fetch_add((uint64_t)ns, std::memory_order_relaxed);
+        }
+        stats[index].jobs.fetch_add(1, std::memory_order_relaxed);
+        job.counter->fetch_sub(1);
+    }
+
+    void worker_loop(int index) {
+        current_worker_index() = index;
+        while (true) {
+            Job job;
+            if (find_job(index, job)) {
+                execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [this]() { return !running || pendingJobs.load() > 0; });
+            if (!running) return;
+        }
+    }
+};
+
+//    .      ,
+// run()       .
+class TaskGraph {
+public:
+    struct Node {
+        const char* name;
+        void (*func)(void* data);
+        void* data;
+        std::vector<uint32_t> successors;
+        int dependencyCount;
+        std::atomic<int> pending{ 0 };
+        double lastMs;
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+
+    template <typename Func>
+    uint32_t add(const char* name, Func* func) {
+        std::unique_ptr<Node> node(new Node());
+        node->name = name;
+        node->func = [](void* data) { (*static_cast<Func*>(data))(); };
+        node->data = func;
+        node->dependencyCount = 0;
+        node->lastMs = 0.0;
+        nodes.push_back(std::move(node));
+        return (uint32_t)nodes.size() - 1;
+    }
+
+    // after    before
+    void depend(uint32_t before, uint32_t after) {
+        nodes[before]->successors.push_back(after);
+        nodes[after]->dependencyCount++;
+    }
+
+    void run(JobSystem& jobs) {
+        std::atomic<int> counter(0);
+        runContext = { this, &jobs, &counter };
+
+        for (auto& node : nodes) node->pending = node->dependencyCount;
+        for (uint32_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i]->dependencyCount == 0) schedule(i);
+        }
+        jobs.wait(counter);
+    }
+
+private:
+    struct RunContext {
+        TaskGraph* graph;
+        JobSystem* jobs;
+        std::atomic<int>* counter;
+    };
+    RunContext runContext = { nullptr, nullptr, nullptr };
+
+    void schedule(uint32_t index) {
+        Job job;
+        job.func = [](void* data, uint32_t begin, uint32_t) {
+            RunContext& ctx = *static_cast<RunContext*>(data);
+            Node& node = *ctx.graph->nodes[begin];
+
+            auto start = std::chrono::steady_clock::now();
+            node.func(node.data);
+            node.lastMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+            for (uint32_t next : node.successors) {
+                if (ctx.graph->nodes[next]->pending.fetch_sub(1) == 1) {
+                    ctx.graph->schedule(next);
+                }
+            }
+        };
+        job.data = &runContext;
+        job.begin = index;
+        job.end = index + 1;
+        job.counter = runContext.counter;
+        runContext.jobs->submit(job);
+    }
+};
+
+#endif
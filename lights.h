@@ -0,0 +1,179 @@
+#ifndef LIGHTS_H
+#define LIGHTS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct PointLight {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;  //    
+};
+
+//   :    
+// TILES_X x TILES_Y x SLICES  (   ).
+//        CPU,  
+//        .
+class ClusteredLights {
+public:
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES = 24;
+    static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+    static const int MAX_LIGHTS = 1024;
+
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;   //     
+
+    std::vector<PointLight> lights;  //     assign()
+    size_t visibleLights = 0;
+    size_t indexCount = 0;
+
+    //    : slice = log(depth / near) * slice_scale()
+    float slice_scale() const { return SLICES / logf(farPlane / nearPlane); }
+
+    ClusteredLights() : clusterTexels(CLUSTER_COUNT * 2), clusterFill(CLUSTER_COUNT) {
+        lightTexels.reserve(MAX_LIGHTS * 2);
+        ranges.reserve(MAX_LIGHTS);
+    }
+
+    void create() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        for (int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    //    : ,  , 
+    void assign(const glm::mat4& view, const glm::mat4& projection) {
+        lightTexels.clear();
+        ranges.clear();
+        std::fill(clusterTexels.begin(), clusterTexels.end(), 0u);
+
+        float scale = slice_scale();
+        size_t count = std::min(lights.size(), (size_t)MAX_LIGHTS);
+        for (size_t i = 0; i < count; i++) {
+            const PointLight& light = lights[i];
+            glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            float depth = -center.z;
+            float r = light.radius;
+            if (depth + r < nearPlane || depth - r > farPlane) continue;
+
+            float dMin = std::max(nearPlane, depth - r);
+            float dMax = std::min(farPlane, depth + r);
+
+            //  x/d   d,     
+            float xMin = projection[0][0] * std::min((center.x - r) / dMin, (center.x - r) / dMax);
+            float xMax = projection[0][0] * std::max((center.x + r) / dMin, (center.x + r) / dMax);
+            float yMin = projection[1][1] * std::min((center.y - r) / dMin, (center.y - r) / dMax);
+            float yMax = projection[1][1] * std::max((center.y + r) / dMin, (center.y + r) / dMax);
+            if (xMax < -1.0f || xMin > 1.0f || yMax < -1.0f || yMin > 1.0f) continue;
+
+            Range range;
+            range.x0 = tile(xMin, TILES_X);
+            range.x1 = tile(xMax, TILES_X);
+            range.y0 = tile(yMin, TILES_Y);
+            range.y1 = tile(yMax, TILES_Y);
+            range.z0 = slice(dMin, scale);
+            range.z1 = slice(dMax, scale);
+            range.light = (uint32_t)(lightTexels.size() / 2);
+            ranges.push_back(range);
+
+            lightTexels.push_back(glm::vec4(light.position, r));
+            lightTexels.push_back(glm::vec4(light.color, 0.0f));
+        }
+        visibleLights = ranges.size();
+
+        for (const Range& range : ranges) {
+            for_each_cluster(range, [&](uint32_t c) { clusterTexels[c * 2 + 1]++; });
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t c = 0; c < CLUSTER_COUNT; c++) {
+            clusterTexels[c * 2] = offset;
+            clusterFill[c] = offset;
+            offset += clusterTexels[c * 2 + 1];
+        }
+        indexCount = offset;
+
+        indices.resize(std::max<size_t>(indexCount, 1));
+        for (const Range& range : ranges) {
+            for_each_cluster(range, [&](uint32_t c) { indices[clusterFill[c]++] = range.light; });
+        }
+    }
+
+    //    (   ) -   GL-
+    void upload() {
+        upload_buffer(0, lightTexels.data(), lightTexels.size() * sizeof(glm::vec4));
+        upload_buffer(1, clusterTexels.data(), clusterTexels.size() * sizeof(uint32_t));
+        upload_buffer(2, indices.data(), indexCount * sizeof(uint32_t));
+    }
+
+    //     firstUnit .. firstUnit + 2
+    void bind(int firstUnit) const {
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    struct Range {
+        int x0, x1, y0, y1, z0, z1;
+        uint32_t light;
+    };
+
+    unsigned int buffers[3] = {};
+    unsigned int textures[3] = {};
+
+    std::vector<glm::vec4> lightTexels;     //  + , 
+    std::vector<uint32_t> clusterTexels;    // , 
+    std::vector<uint32_t> clusterFill;
+    std::vector<uint32_t> indices;
+    std::vector<Range> ranges;
+
+    static int tile(float ndc, int tiles) {
+        return std::min(tiles - 1, std::max(0, (int)((ndc * 0.5f + 0.5f) * tiles)));
+    }
+
+    int slice(float depth, float scale) const {
+        return std::min(SLICES - 1, std::max(0, (int)(logf(depth / nearPlane) * scale)));
+    }
+
+    template <typename Func>
+    static void for_each_cluster(const Range& range, Func func) {
+        for (int z = range.z0; z <= range.z1; z++) {
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++) {
+                    func((uint32_t)((z * TILES_Y + y) * TILES_X + x));
+                }
+            }
+        }
+    }
+
+    void upload_buffer(int index, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)std::max<size_t>(bytes, 16), NULL, GL_STREAM_DRAW);
+        if (bytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)bytes, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
@@ -8,15 +8,48 @@
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <ctime>
-#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <cstdlib>
 
 #include "camera.h"
 #include "shaders.h"
+#include "ecs.h"
+#include "transform.h"
+#include "jobs.h"
+#include "culling.h"
+#include "profiler.h"
+#include "pool.h"
+#include "rng.h"
+#include "poisson.h"
+#include "stream_buffer.h"
+#include "bvh.h"
+#include "occlusion.h"
+#include "lights.h"
+#include "shadows.h"
+#include "resolution.h"
+#include "frame_pacing.h"
+#include "gpu_memory.h"
+#include "texture_streamer.h"
+#include "fleet.h"
+#include "snapshot.h"
+#include "snow.h"
+#include "capture.h"
+#include "minimap.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define ALLOC_COUNTER_IMPLEMENTATION
+#include "alloc_counter.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -24,51 +57,133 @@
 const int NUM_HOUSES = 10;
 const int NUM_TREES = 15;
 const int NUM_ROCKS = 10;
-const int NUM_PACKAGES_MAX = 20;
+const int NUM_PACKAGES_MAX = 20;          //     
+const int PACKAGE_POOL_CAPACITY = 8192;   //    
+const int FLEET_SIZE = 0;                 // -,   FLEET_SIZE
+const float WORLD_HALF_EXTENT = 200.0f;
+const uint64_t WORLD_SEED = 20240517;
+const float TREE_LOD_DISTANCE = 150.0f;
+const float OCCLUDER_MIN_SIZE = 0.02f;   //  / 
+const size_t MAX_OCCLUDERS = 256;
+const float ROCK_OCCLUDER_SCALE = 0.8f;  //     
+const float HOUSE_WALL_HEIGHT = 8.0f;    // :     
+const float PACKAGE_RADIUS = 0.5f;
+const float GRAVITY = 9.8f * 5.0f;
+const glm::vec3 PACKAGE_DROP_VELOCITY(0, -20.0f, 0);
+
+//    BVH 
+const uint32_t COLLIDE_STATIC = 1;
+const size_t GPU_MEMORY_BUDGET_MB = 256;   //   GPU_BUDGET_MB
+const int SNOW_FLAKES = 200000;           //   SNOW_FLAKES
+const char* const SNAPSHOT_PATH = "world.snap";   // F5 - , F9 - 
+const char* const CAPTURE_PREFIX = "capture";     // F12 -  , CAPTURE=png|raw -  
+
+//  
+struct Renderable {
+    int mesh;
+    glm::vec3 color;
+    bool useTexture;
+};
 
 struct House {
-    glm::vec3 position;
     bool hasPackage;
     int houseType; 
 };
 
+//    ,    :     
 struct Package {
-    glm::vec3 position;
+    Transform transform;
     glm::vec3 velocity;
-    bool active;
-    float rotation;
     float rotationSpeed;
+    bool fromPlayer;
 };
 
 struct TreeObject {
-    glm::vec3 position;
     float windOffset;
     float treeHeight;
 };
 
+struct Rock {
+    int variant;
+};
+
 struct Vertex {
     glm::vec3 position;
     glm::vec2 texCoords;
     glm::vec3 normal;
     glm::vec3 tangent;
     float type;
+    float handedness = 1.0f;   //  ,   computeTangents
+};
+
+//     -
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;   // rgb +  
+    glm::vec4 params;  //  ,  ,  
 };
 
+//     ,  std140 ( FrameData)
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightDir;    // xyz
+    glm::vec4 params;      // ,  ,  
+    glm::vec4 ambient;     // rgb
+    glm::vec4 clusterParams;  //    ,  ,  
+    glm::vec4 screenParams;   // , ,   x   y
+    glm::mat4 lightMatrices[ShadowCascades::CASCADES];
+};
+
+const unsigned int FRAME_DATA_BINDING = 0;
+
 struct GameObject {
     unsigned int vao;
     unsigned int texture;
     unsigned int normalMap;
-    int vertexCount;
+    int indexCount;
     glm::vec3 baseColor;
     std::string name;
+    glm::vec3 boundCenter;
+    float boundRadius;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
 };
 
-std::vector<House> houses;
-std::vector<TreeObject> treePositions;
-std::vector<glm::vec3> rockPositions;
-std::vector<Package> packages;
+enum MeshId {
+    MESH_FIELD, MESH_TREE, MESH_ROCK, MESH_HOUSE1, MESH_HOUSE2, MESH_HOUSE3,
+    MESH_AIRSHIP, MESH_PACKAGE, MESH_TREE_LOW, MESH_COUNT
+};
 
-GameObject airship, field, tree, rock, house1, house2, house3, packageObj;
+Registry world;
+TransformSystem transformSystem;
+JobSystem jobs;
+Profiler profiler;
+std::vector<InstanceData> instanceLists[MESH_COUNT];
+Pool<Package> packages(PACKAGE_POOL_CAPACITY);
+Rng gameRng(WORLD_SEED);
+StreamBuffer streamBuffer;
+Bvh sceneBvh;
+std::vector<Entity> colliderEntities;
+//    sceneBvh:      
+std::vector<Aabb> occluderBoxes;
+std::vector<glm::mat4> occluderMatrices;
+glm::vec3 aimImpact(0.0f);
+bool aimImpactValid = false;
+OcclusionBuffer occlusionBuffer;
+bool occlusionEnabled = true;
+ClusteredLights clusteredLights;
+ShadowCascades shadowCascades;
+std::vector<InstanceData> shadowStatic[ShadowCascades::CASCADES][MESH_COUNT];
+std::vector<InstanceData> shadowDynamic[ShadowCascades::CASCADES][MESH_COUNT];
+size_t shadowStaticOffsets[ShadowCascades::CASCADES][MESH_COUNT];
+size_t shadowDynamicOffsets[ShadowCascades::CASCADES][MESH_COUNT];
+size_t instanceOffsets[MESH_COUNT];
+Entity fieldEntity = NULL_ENTITY;
+Entity playerAirship = NULL_ENTITY;
+
+GameObject airship, field, tree, rock, house1, house2, house3, packageObj, treeLow;
+GameObject* meshes[MESH_COUNT] = { &field, &tree, &rock, &house1, &house2, &house3, &airship, &packageObj, &treeLow };
 Camera camera;
 glm::vec3 airshipPosition(0, 100, 0);
 float airshipSpeed = 50.0f;
@@ -77,98 +192,136 @@ bool aimMode = false;
 bool cPressed = false;
 float windTime = 0.0f;
 int deliveredPackages = 0;
+int fleetDeliveries = 0;     //  ,     
+
+Fleet fleet;
+std::vector<Entity> fleetHouses;
+std::vector<glm::vec3> fleetHousePositions;
+std::vector<uint8_t> houseOpen;
 int totalHouses = 0;
 bool gameStarted = false;
 
-void generate_package(std::vector<Vertex>& vertices);
-void computeTangents(std::vector<Vertex>& vertices);
-
-unsigned int load_texture(const char* path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+DynamicResolution dynamicResolution;
+FramePacer framePacer;
+GpuMemory gpuMemory;
+TextureStreamer textureStreamer(gpuMemory);
+Snowfall snowfall;
+FrameCapture frameCapture;
+Minimap minimap;
+int playerInstanceIndex = -1;   //      MESH_AIRSHIP
+bool framebufferResized = false;
 
-        std::cout << "Texture loaded successfully: " << path
-            << " (" << width << "x" << height << ", channels: " << nrComponents << ")" << std::endl;
-
-        stbi_image_free(data);
+void generate_package(std::vector<Vertex>& vertices);
+void computeTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+struct VertexKeyHash {
+    size_t operator()(const Vertex& v) const {
+        const float* f = &v.position.x;
+        size_t h = 1469598103934665603ull;
+        for (int i = 0; i < 8; i++) {
+            uint32_t bits;
+            memcpy(&bits, f + i, sizeof(bits));
+            h = (h ^ bits) * 1099511628211ull;
+        }
+        return h;
     }
-    else {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        if (data) stbi_image_free(data);
-
-        unsigned char fallbackData[] = {
-            200, 200, 200,   100, 100, 100,
-            100, 100, 100,   200, 200, 200
-        };
+};
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, fallbackData);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+struct VertexKeyEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const {
+        return a.position == b.position && a.texCoords == b.texCoords &&
+            a.normal == b.normal && a.type == b.type;
     }
+};
 
-    return textureID;
+//    (, UV, , )   
+void build_indexed_mesh(const std::vector<Vertex>& soup,
+    std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+
+    std::unordered_map<Vertex, unsigned int, VertexKeyHash, VertexKeyEqual> lookup;
+    lookup.reserve(soup.size());
+    vertices.clear();
+    indices.clear();
+    indices.reserve(soup.size());
+
+    for (const Vertex& v : soup) {
+        auto it = lookup.find(v);
+        if (it == lookup.end()) {
+            it = lookup.emplace(v, (unsigned int)vertices.size()).first;
+            vertices.push_back(v);
+        }
+        indices.push_back(it->second);
+    }
 }
 
-void computeTangents(std::vector<Vertex>& vertices) {
-    for (size_t i = 0; i < vertices.size(); i += 3) {
-        if (i + 2 >= vertices.size()) break;
+//   :    ,
+//  -     handedness
+void computeTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+    const uint32_t vertexCount = (uint32_t)vertices.size();
+    const uint32_t grain = 4096;
+
+    std::vector<glm::vec3> triTangent(triangleCount);
+    std::vector<glm::vec3> triBitangent(triangleCount);
+
+    jobs.parallel_for(triangleCount, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; t++) {
+            const Vertex& v0 = vertices[indices[t * 3]];
+            const Vertex& v1 = vertices[indices[t * 3 + 1]];
+            const Vertex& v2 = vertices[indices[t * 3 + 2]];
+
+            glm::vec3 edge1 = v1.position - v0.position;
+            glm::vec3 edge2 = v2.position - v0.position;
+            glm::vec2 deltaUV1 = v1.texCoords - v0.texCoords;
+            glm::vec2 deltaUV2 = v2.texCoords - v0.texCoords;
+
+            float denom = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+            if (fabs(denom) < 1e-8f) {
+                triTangent[t] = glm::vec3(0.0f);
+                triBitangent[t] = glm::vec3(0.0f);
+                continue;
+            }
+            float f = 1.0f / denom;
 
-        Vertex& v0 = vertices[i];
-        Vertex& v1 = vertices[i + 1];
-        Vertex& v2 = vertices[i + 2];
+            triTangent[t] = f * (deltaUV2.y * edge1 - deltaUV1.y * edge2);
+            triBitangent[t] = f * (deltaUV1.x * edge2 - deltaUV2.x * edge1);
+        }
+    });
 
-        glm::vec3 edge1 = v1.position - v0.position;
-        glm::vec3 edge2 = v2.position - v0.position;
-        glm::vec2 deltaUV1 = v1.texCoords - v0.texCoords;
-        glm::vec2 deltaUV2 = v2.texCoords - v0.texCoords;
+    // ,     (CSR)
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+    for (unsigned int index : indices) adjacencyStart[index + 1]++;
+    for (size_t i = 0; i < vertexCount; i++) adjacencyStart[i + 1] += adjacencyStart[i];
 
-        float f = 1.0f;
-        float denom = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
-        if (fabs(denom) > 0.0001f) {
-            f = 1.0f / denom;
-        }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) {
+        adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+    }
 
-        glm::vec3 tangent;
-        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+    jobs.parallel_for(vertexCount, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t v = begin; v < end; v++) {
+            glm::vec3 tan(0.0f);
+            glm::vec3 bitan(0.0f);
+            for (unsigned int a = adjacencyStart[v]; a < adjacencyStart[v + 1]; a++) {
+                tan += triTangent[adjacency[a]];
+                bitan += triBitangent[adjacency[a]];
+            }
 
-        if (glm::length(tangent) > 0.0001f) {
-            tangent = glm::normalize(tangent);
-        }
-        else {
-            tangent = glm::vec3(1.0f, 0.0f, 0.0f);
-        }
+            Vertex& vert = vertices[v];
+            glm::vec3 n = vert.normal;
+            glm::vec3 t = tan - n * glm::dot(n, tan);
 
-        v0.tangent = tangent;
-        v1.tangent = tangent;
-        v2.tangent = tangent;
-    }
+            if (glm::length(t) < 1e-6f) {
+                //  UV-:  ,  
+                glm::vec3 axis = fabs(n.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+                t = glm::cross(glm::cross(n, axis), n);
+            }
+
+            vert.tangent = glm::normalize(t);
+            vert.handedness = glm::dot(glm::cross(n, vert.tangent), bitan) < 0.0f ? -1.0f : 1.0f;
+        }
+    });
 }
 
 void generate_package(std::vector<Vertex>& vertices) {
@@ -209,8 +362,6 @@ void generate_package(std::vector<Vertex>& vertices) {
         vertices.push_back({ verticesList[faces[face][2]], {1,1}, normal, {1,0,0}, 1.0f });
         vertices.push_back({ verticesList[faces[face][3]], {0,1}, normal, {1,0,0}, 1.0f });
     }
-
-    computeTangents(vertices);
 }
 
 void load_obj(const std::string& path, std::vector<Vertex>& vertices) {
@@ -255,14 +406,14 @@ void generate_terrain(std::vector<Vertex>& vertices) {
     }
 }
 
-void generate_tree(std::vector<Vertex>& vertices, float height = 12.0f) {
+void generate_tree(std::vector<Vertex>& vertices, float height = 12.0f,
+    int trunkSegments = 8, int crownSegments = 16) {
     float trunkRadius = 0.8f;
     float trunkHeight = height * 0.6f;
     float crownRadius = 2.5f;
     float crownHeight = height * 0.4f;
 
     //  
-    int trunkSegments = 8;
     for (int i = 0; i < trunkSegments; i++) {
         float angle1 = 2.0f * M_PI * i / trunkSegments;
         float angle2 = 2.0f * M_PI * (i + 1) / trunkSegments;
@@ -291,7 +442,6 @@ void generate_tree(std::vector<Vertex>& vertices, float height = 12.0f) {
     }
 
     //   
-    int crownSegments = 16;
     glm::vec3 crownTop(0, trunkHeight + crownHeight, 0);
 
     for (int i = 0; i < crownSegments; i++) {
@@ -364,7 +514,7 @@ void generate_rock(std::vector<Vertex>& vertices) {
 void generate_house(std::vector<Vertex>& vertices, int type) {
     //   
     float size = 5.0f;
-    float height = 8.0f;
+    float height = HOUSE_WALL_HEIGHT;
 
     //  
     glm::vec3 base[8] = {
@@ -466,42 +616,73 @@ void generate_airship(std::vector<Vertex>& vertices) {
 GameObject create_object(const std::string& type, const std::string& texturePath = "",
     const std::string& normalPath = "", const glm::vec3& color = glm::vec3(1.0f)) {
 
-    std::vector<Vertex> vertices;
+    std::vector<Vertex> soup;
 
     if (type == "FIELD") {
-        generate_terrain(vertices);
+        generate_terrain(soup);
     }
     else if (type == "TREE") {
-        generate_tree(vertices, 12.0f);
+        generate_tree(soup, 12.0f);
+    }
+    else if (type == "TREE_LOW") {
+        generate_tree(soup, 12.0f, 4, 6);
     }
     else if (type == "ROCK") {
-        generate_rock(vertices);
+        generate_rock(soup);
     }
     else if (type == "HOUSE1" || type == "HOUSE2" || type == "HOUSE3") {
-        generate_house(vertices, 0);
+        generate_house(soup, 0);
     }
     else if (type == "AIRSHIP") {
-        generate_airship(vertices);
+        generate_airship(soup);
     }
     else if (type == "PACKAGE") {
-        generate_package(vertices);
+        generate_package(soup);
     }
 
-    if (vertices.empty()) {
+    if (soup.empty()) {
         std::cout << "Warning: No vertices generated for " << type << std::endl;
-        generate_package(vertices); 
+        generate_package(soup); 
     }
 
-    computeTangents(vertices);
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    build_indexed_mesh(soup, vertices, indices);
+    computeTangents(vertices, indices);
+
+    //    
+    glm::vec3 boundsMin = vertices[0].position;
+    glm::vec3 boundsMax = vertices[0].position;
+    for (const Vertex& v : vertices) {
+        boundsMin = glm::min(boundsMin, v.position);
+        boundsMax = glm::max(boundsMax, v.position);
+    }
+    glm::vec3 boundCenter = (boundsMin + boundsMax) * 0.5f;
+    float boundRadius = 0.0f;
+    for (const Vertex& v : vertices) {
+        boundRadius = std::max(boundRadius, glm::distance(v.position, boundCenter));
+    }
 
-    unsigned int VAO, VBO;
+    unsigned int VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
 
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    size_t vertexBytes = vertices.size() * sizeof(Vertex);
+    size_t indexBytes = indices.size() * sizeof(unsigned int);
+    if (!gpuMemory.fits(vertexBytes + indexBytes)) {
+        std::cout << "Warning: mesh " << type << " does not fit GPU budget" << std::endl;
+    }
+    gpuMemory.track(GpuMemory::BUFFER, VBO, type, "vertices", "Vertex", vertexBytes);
+    gpuMemory.track(GpuMemory::BUFFER, EBO, type, "indices", "R32UI", indexBytes);
+
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
 
@@ -518,125 +699,1085 @@ GameObject create_object(const std::string& type, const std::string& texturePath
     glEnableVertexAttribArray(4);
     glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, type));
 
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, handedness));
+
+    //  :  (4 ), ,  .
+    //        .
+    for (int i = 6; i <= 11; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
     glBindVertexArray(0);
 
     unsigned int texture = 0;
     unsigned int normalMap = 0;
 
+    //   :     
+    static const unsigned char grayFill[3] = { 160, 160, 160 };
+    static const unsigned char flatNormalFill[3] = { 128, 128, 255 };
+
     if (!texturePath.empty()) {
-        texture = load_texture(texturePath.c_str());
+        texture = textureStreamer.request(texturePath, type, grayFill);
     }
 
     if (!normalPath.empty()) {
-        normalMap = load_texture(normalPath.c_str());
+        normalMap = textureStreamer.request(normalPath, type, flatNormalFill);
     }
 
-    return { VAO, texture, normalMap, (int)vertices.size(), color, type };
+    return { VAO, texture, normalMap, (int)indices.size(), color, type, boundCenter, boundRadius, boundsMin, boundsMax };
+}
+
+glm::vec3 house_color(const House& house) {
+    glm::vec3 color = meshes[MESH_HOUSE1 + house.houseType]->baseColor;
+    if (!house.hasPackage) {
+        color = glm::mix(color, glm::vec3(1.0f, 0.0f, 0.0f), 0.3f);
+    }
+    return color;
 }
 
+// ,      :   
+//       WORLD_SEED
 void generate_random_positions() {
-    std::mt19937 rng(time(0));
-    std::uniform_real_distribution<float> distPos(-200.0f, 200.0f);
-    std::uniform_int_distribution<int> distType(0, 2);
+    auto start = std::chrono::steady_clock::now();
 
-    houses.clear();
-    for (int i = 0; i < NUM_HOUSES; i++) {
+    Rng rng(WORLD_SEED);
+    PoissonPlacer placer(WORLD_HALF_EXTENT, WORLD_SEED, &jobs);
+    std::vector<glm::vec2> housePositions = placer.place({ 40.0f, 8.0f, NUM_HOUSES });
+    std::vector<glm::vec2> treePositions = placer.place({ 12.0f, 3.0f, NUM_TREES });
+    std::vector<glm::vec2> rockPositions = placer.place({ 15.0f, 4.5f, NUM_ROCKS });
+
+    world.clear();
+
+    fieldEntity = world.create();
+    world.add(fieldEntity, Transform{ glm::vec3(0.0f), 0.0f, glm::vec3(1.0f) });
+    world.add(fieldEntity, Renderable{ MESH_FIELD, field.baseColor, true });
+
+    playerAirship = world.create();
+    world.add(playerAirship, Transform{ airshipPosition, glm::radians(airshipRotation), glm::vec3(1.0f) });
+    world.add(playerAirship, Renderable{ MESH_AIRSHIP, airship.baseColor, true });
+
+    for (const glm::vec2& p : housePositions) {
         House house;
-        house.position = glm::vec3(distPos(rng), 0, distPos(rng));
         house.hasPackage = false;
-        house.houseType = distType(rng);
-        houses.push_back(house);
+        house.houseType = rng.range_int(0, 2);
+
+        Entity e = world.create();
+        world.add(e, Transform{ glm::vec3(p.x, 0, p.y), 0.0f, glm::vec3(1.0f) });
+        world.add(e, house);
+        world.add(e, Renderable{ MESH_HOUSE1 + house.houseType, house_color(house), true });
     }
 
-    treePositions.clear();
-    for (int i = 0; i < NUM_TREES; i++) {
-        TreeObject tree;
-        tree.position = glm::vec3(distPos(rng), 0, distPos(rng));
-        tree.windOffset = distPos(rng); 
-        tree.treeHeight = 10.0f + (rand() % 50) / 10.0f; 
-        treePositions.push_back(tree);
+    for (const glm::vec2& p : treePositions) {
+        TreeObject treeData;
+        treeData.windOffset = rng.range(-200.0f, 200.0f); 
+        treeData.treeHeight = rng.range(10.0f, 15.0f); 
+
+        Entity e = world.create();
+        world.add(e, Transform{ glm::vec3(p.x, 0, p.y), 0.0f, glm::vec3(1.0f, treeData.treeHeight / 12.0f, 1.0f) });
+        world.add(e, treeData);
+        world.add(e, Renderable{ MESH_TREE, tree.baseColor, true });
     }
 
-    rockPositions.clear();
-    for (int i = 0; i < NUM_ROCKS; i++) {
-        rockPositions.push_back(glm::vec3(distPos(rng), 0, distPos(rng)));
+    for (const glm::vec2& p : rockPositions) {
+        Entity e = world.create();
+        world.add(e, Transform{ glm::vec3(p.x, 0, p.y), 0.0f, glm::vec3(1.0f) });
+        world.add(e, Rock{ 0 });
+        world.add(e, Renderable{ MESH_ROCK, rock.baseColor, true });
     }
 
-    totalHouses = NUM_HOUSES;
+    totalHouses = (int)housePositions.size();
     deliveredPackages = 0;
+    fleetDeliveries = 0;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Placed " << housePositions.size() << " houses, " << treePositions.size() << " trees, "
+        << rockPositions.size() << " rocks in " << ms << " ms (seed " << WORLD_SEED << ")" << std::endl;
+    if ((int)housePositions.size() < NUM_HOUSES || (int)treePositions.size() < NUM_TREES ||
+        (int)rockPositions.size() < NUM_ROCKS) {
+        std::cout << "Warning: world is too small for the requested object counts" << std::endl;
+    }
 }
 
-void drop_package() {
+//  AABB     
+Aabb entity_bounds(Entity e, int mesh) {
+    const GameObject& obj = *meshes[mesh];
+    return transform_aabb(obj.boundsMin, obj.boundsMax, transform_matrix(world.get<Transform>(e)));
+}
+
+//    :      
+//      .   -  
+// ,   -      .
+Aabb occluder_box(int mesh) {
+    const GameObject& obj = *meshes[mesh];
+    Aabb box;
+    box.min = obj.boundsMin;
+    box.max = obj.boundsMax;
+    if (mesh == MESH_ROCK) {
+        glm::vec3 center = (box.min + box.max) * 0.5f;
+        box.min = center + (box.min - center) * ROCK_OCCLUDER_SCALE;
+        box.max = center + (box.max - center) * ROCK_OCCLUDER_SCALE;
+    }
+    else {
+        box.max.y = std::min(box.max.y, HOUSE_WALL_HEIGHT);
+    }
+    return box;
+}
+
+//  BVH    
+void build_colliders() {
+    sceneBvh.clear();
+    colliderEntities.clear();
+    occluderBoxes.clear();
+    occluderMatrices.clear();
+
+    auto add = [&](Entity e, int mesh, uint32_t mask) {
+        colliderEntities.push_back(e);
+        sceneBvh.add(entity_bounds(e, mesh), mask);
+        occluderBoxes.push_back(occluder_box(mesh));
+        occluderMatrices.push_back(transform_matrix(world.get<Transform>(e)));
+    };
+    world.each<House, Renderable>([&](Entity e, House&, Renderable& r) { add(e, r.mesh, COLLIDE_STATIC); });
+    world.each<Rock, Renderable>([&](Entity e, Rock&, Renderable& r) { add(e, r.mesh, COLLIDE_STATIC); });
+
+    sceneBvh.build();
+    std::cout << "Scene BVH: " << sceneBvh.boxes.size() << " objects, " << sceneBvh.nodes.size() << " nodes" << std::endl;
+}
+
+//   :    ,   .
+//  true  , hitItem -  BVH  INVALID_INDEX  .
+bool package_step(glm::vec3& position, glm::vec3& velocity, float deltaTime, uint32_t& hitItem) {
+    glm::vec3 delta = velocity * deltaTime;
+    velocity.y -= GRAVITY * deltaTime;
+    hitItem = INVALID_INDEX;
+
+    BvhHit hit;
+    if (sceneBvh.sphere_cast(position, PACKAGE_RADIUS, delta, COLLIDE_STATIC, hit)) {
+        position += delta * hit.t;
+        hitItem = hit.item;
+        return true;
+    }
+
+    position += delta;
+    if (position.y <= PACKAGE_RADIUS) {
+        position.y = PACKAGE_RADIUS;
+        return true;
+    }
+    return false;
+}
+
+//   ,    :    
+bool predict_impact(glm::vec3 position, glm::vec3 velocity, glm::vec3& impact) {
+    const float step = 1.0f / 30.0f;
+    for (int i = 0; i < 300; i++) {
+        glm::vec3 delta = velocity * step;
+        velocity.y -= GRAVITY * step;
+
+        BvhHit hit;
+        if (sceneBvh.raycast(position, delta, 1.0f, COLLIDE_STATIC, hit)) {
+            impact = position + delta * hit.t;
+            return true;
+        }
+        position += delta;
+        if (position.y <= 0.0f) {
+            impact = glm::vec3(position.x, 0.0f, position.z);
+            return true;
+        }
+    }
+    return false;
+}
+
+glm::vec3 package_drop_position() {
+    return airshipPosition + glm::vec3(0, -10, 0);
+}
+
+void spawn_package(const glm::vec3& position, bool fromPlayer) {
     Package pkg;
-    pkg.position = airshipPosition + glm::vec3(0, -10, 0);
-    pkg.velocity = glm::vec3(0, -20.0f, 0);
-    pkg.active = true;
-    pkg.rotation = 0.0f;
-    pkg.rotationSpeed = (rand() % 100) / 100.0f * 2.0f;
+    pkg.transform = Transform{ position, 0.0f, glm::vec3(1.0f) };
+    pkg.velocity = PACKAGE_DROP_VELOCITY;
+    pkg.rotationSpeed = gameRng.range(0.0f, 2.0f);
+    pkg.fromPlayer = fromPlayer;
+
+    packages.create(pkg);
+}
+
+void drop_package() {
+    spawn_package(package_drop_position(), true);
+}
+
+int player_packages_in_flight() {
+    int count = 0;
+    for (uint32_t i = 0; i < packages.size(); i++) {
+        if (packages.at(i).fromPlayer) count++;
+    }
+    return count;
+}
+
+std::vector<uint8_t> landedFlags(PACKAGE_POOL_CAPACITY);
+std::vector<uint32_t> landedItems(PACKAGE_POOL_CAPACITY);
+
+//      House -   
+void collect_fleet_houses() {
+    fleetHouses.clear();
+    fleetHousePositions.clear();
+    world.each<House, Transform>([&](Entity e, House&, Transform& t) {
+        fleetHouses.push_back(e);
+        fleetHousePositions.push_back(t.position);
+    });
+    houseOpen.resize(fleetHouses.size());
+}
 
-    packages.push_back(pkg);
+//       ,   
+void spawn_fleet(int count) {
+    fleet.clear();
+    fleet.worldHalfExtent = WORLD_HALF_EXTENT;
+    fleet.shipRadius = airship.boundRadius;
+    collect_fleet_houses();
+
+    Rng rng(mix_seed(WORLD_SEED, 41));
+    for (int i = 0; i < count; i++) {
+        float angle = 2.0f * (float)M_PI * i / count;
+        glm::vec3 position(sinf(angle) * WORLD_HALF_EXTENT * 0.9f, 0.0f, cosf(angle) * WORLD_HALF_EXTENT * 0.9f);
+        //   (-sin, -cos)   -   
+        float heading = angle;
+
+        glm::vec3 color = airship.baseColor * rng.range(0.5f, 1.0f) + glm::vec3(0.0f, rng.range(0.0f, 0.4f), rng.range(0.0f, 0.6f));
+        Entity e = world.create();
+        fleet.add(e, position, heading, mix_seed(WORLD_SEED, 1000 + i));
+        world.add(e, Transform{ fleet.positions.back(), heading, glm::vec3(1.0f) });
+        world.add(e, Renderable{ MESH_AIRSHIP, color, true });
+    }
+    fleet.build();
+    std::cout << "Fleet: " << count << " airships" << std::endl;
+}
+
+//  (),    Transform (), 
+void update_fleet(float deltaTime) {
+    ComponentArray<House>& houseStore = world.storage<House>();
+    for (size_t h = 0; h < fleetHouses.size(); h++) {
+        houseOpen[h] = houseStore.get(fleetHouses[h]).hasPackage ? 0 : 1;
+    }
+    fleet.assign_targets(deltaTime, fleetHousePositions, houseOpen);
+    fleet.steer(jobs, deltaTime, fleetHousePositions);
+
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    jobs.parallel_for((uint32_t)fleet.size(), 256, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            Transform& t = transforms.get(fleet.entities[i]);
+            t.position = fleet.positions[i];
+            t.rotation = fleet.headings[i];
+            t.dirty = true;
+        }
+    });
+
+    fleet.take_drops([](const glm::vec3& position) {
+        if (!packages.full()) spawn_package(position + glm::vec3(0, -10, 0), false);
+    });
+}
+
+//  :   ,    .
+//       -  SNAPSHOT_VERSION.
+const uint32_t SNAPSHOT_VERSION = 2;
+
+enum SnapshotSectionId {
+    SNAP_PLAYER, SNAP_HOUSES, SNAP_TREES, SNAP_ROCKS, SNAP_PACKAGES,
+    SNAP_FLEET_POSITIONS, SNAP_FLEET_VELOCITIES, SNAP_FLEET_HEADINGS, SNAP_FLEET_ALTITUDES,
+    SNAP_FLEET_TARGETS, SNAP_FLEET_WAYPOINTS, SNAP_FLEET_RNGS, SNAP_FLEET_COLORS,
+    SNAP_FLEET_CLAIMS, SNAP_FLEET_RECLAIM_TIMERS
+};
+
+struct SnapshotPlayer {
+    glm::vec3 airshipPosition;
+    float airshipRotation;
+    float airshipSpeed;
+    float windTime;
+    int32_t deliveredPackages;
+    int32_t fleetDeliveries;
+    int32_t totalHouses;
+    Rng gameRng;
+};
+
+struct SnapshotHouse {
+    glm::vec3 position;
+    float rotation;
+    int32_t houseType;
+    uint32_t hasPackage;
+};
+
+struct SnapshotTree {
+    glm::vec3 position;
+    float rotation;
+    float windOffset;
+    float treeHeight;
+};
+
+struct SnapshotRock {
+    glm::vec3 position;
+    float rotation;
+    int32_t variant;
+};
+
+struct SnapshotPackage {
+    glm::vec3 position;
+    float rotation;
+    glm::vec3 velocity;
+    float rotationSpeed;
+    uint32_t fromPlayer;
+};
+
+//  ,     
+bool save_world_snapshot(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    SnapshotPlayer player = { airshipPosition, airshipRotation, airshipSpeed, windTime,
+        deliveredPackages, fleetDeliveries, totalHouses, gameRng };
+
+    std::vector<SnapshotHouse> houses;
+    world.each<House, Transform>([&](Entity, House& house, Transform& t) {
+        houses.push_back({ t.position, t.rotation, house.houseType, house.hasPackage ? 1u : 0u });
+    });
+    std::vector<SnapshotTree> trees;
+    world.each<TreeObject, Transform>([&](Entity, TreeObject& treeData, Transform& t) {
+        trees.push_back({ t.position, t.rotation, treeData.windOffset, treeData.treeHeight });
+    });
+    std::vector<SnapshotRock> rocks;
+    world.each<Rock, Transform>([&](Entity, Rock& r, Transform& t) {
+        rocks.push_back({ t.position, t.rotation, r.variant });
+    });
+    std::vector<SnapshotPackage> flying;
+    for (uint32_t i = 0; i < packages.size(); i++) {
+        const Package& pkg = packages.at(i);
+        flying.push_back({ pkg.transform.position, pkg.transform.rotation, pkg.velocity, pkg.rotationSpeed,
+            pkg.fromPlayer ? 1u : 0u });
+    }
+    std::vector<glm::vec3> fleetColors;
+    for (Entity e : fleet.entities) fleetColors.push_back(world.get<Renderable>(e).color);
+
+    SnapshotWriter writer(SNAPSHOT_VERSION);
+    writer.add_value(SNAP_PLAYER, player);
+    writer.add(SNAP_HOUSES, houses);
+    writer.add(SNAP_TREES, trees);
+    writer.add(SNAP_ROCKS, rocks);
+    writer.add(SNAP_PACKAGES, flying);
+    //         
+    writer.add(SNAP_FLEET_POSITIONS, fleet.positions);
+    writer.add(SNAP_FLEET_VELOCITIES, fleet.velocities);
+    writer.add(SNAP_FLEET_HEADINGS, fleet.headings);
+    writer.add(SNAP_FLEET_ALTITUDES, fleet.altitudes);
+    writer.add(SNAP_FLEET_TARGETS, fleet.targets);
+    writer.add(SNAP_FLEET_WAYPOINTS, fleet.waypoints);
+    writer.add(SNAP_FLEET_RNGS, fleet.rngs);
+    writer.add(SNAP_FLEET_COLORS, fleetColors);
+    writer.add(SNAP_FLEET_CLAIMS, fleet.claimedBy);
+    writer.add(SNAP_FLEET_RECLAIM_TIMERS, fleet.reclaimTimers);
+
+    if (!writer.write(path)) {
+        std::cout << "Failed to write snapshot " << path << std::endl;
+        return false;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Snapshot saved to " << path << ": " << houses.size() << " houses, " << trees.size() << " trees, "
+        << rocks.size() << " rocks, " << flying.size() << " packages, " << fleet.size() << " ships in "
+        << ms << " ms" << std::endl;
+    return true;
+}
+
+//      :    world.clear()
+bool load_world_snapshot(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    SnapshotReader reader;
+    if (!reader.open(path, SNAPSHOT_VERSION)) {
+        std::cout << "Failed to load snapshot " << path << ": " << reader.error << std::endl;
+        return false;
+    }
+
+    SnapshotPlayer player;
+    size_t houseCount, treeCount, rockCount, packageCount, colorCount;
+    const SnapshotHouse* houses = reader.section<SnapshotHouse>(SNAP_HOUSES, houseCount);
+    const SnapshotTree* trees = reader.section<SnapshotTree>(SNAP_TREES, treeCount);
+    const SnapshotRock* rocks = reader.section<SnapshotRock>(SNAP_ROCKS, rockCount);
+    const SnapshotPackage* flying = reader.section<SnapshotPackage>(SNAP_PACKAGES, packageCount);
+    const glm::vec3* fleetColors = reader.section<glm::vec3>(SNAP_FLEET_COLORS, colorCount);
+
+    Fleet loaded;
+    bool complete = reader.read_value(SNAP_PLAYER, player) && houses && trees && rocks && flying && fleetColors &&
+        reader.read(SNAP_FLEET_POSITIONS, loaded.positions) &&
+        reader.read(SNAP_FLEET_VELOCITIES, loaded.velocities) &&
+        reader.read(SNAP_FLEET_HEADINGS, loaded.headings) &&
+        reader.read(SNAP_FLEET_ALTITUDES, loaded.altitudes) &&
+        reader.read(SNAP_FLEET_TARGETS, loaded.targets) &&
+        reader.read(SNAP_FLEET_WAYPOINTS, loaded.waypoints) &&
+        reader.read(SNAP_FLEET_RNGS, loaded.rngs) &&
+        reader.read(SNAP_FLEET_CLAIMS, loaded.claimedBy) &&
+        reader.read(SNAP_FLEET_RECLAIM_TIMERS, loaded.reclaimTimers);
+    if (!complete) {
+        std::cout << "Failed to load snapshot " << path << ": missing or mismatched sections" << std::endl;
+        return false;
+    }
+
+    size_t ships = loaded.positions.size();
+    bool consistent = packageCount <= (size_t)PACKAGE_POOL_CAPACITY && colorCount == ships &&
+        loaded.velocities.size() == ships && loaded.headings.size() == ships && loaded.altitudes.size() == ships &&
+        loaded.targets.size() == ships && loaded.waypoints.size() == ships && loaded.rngs.size() == ships &&
+        (loaded.claimedBy.empty() || loaded.claimedBy.size() == houseCount) &&
+        loaded.reclaimTimers.size() == loaded.claimedBy.size();
+    for (size_t i = 0; consistent && i < ships; i++) {
+        consistent = loaded.targets[i] == Fleet::NO_TARGET || (loaded.targets[i] >= 0 && (size_t)loaded.targets[i] < houseCount);
+    }
+    // assign_targets   targets[claimedBy[h]]:   
+    //       
+    for (size_t h = 0; consistent && h < loaded.claimedBy.size(); h++) {
+        int ship = loaded.claimedBy[h];
+        consistent = ship == Fleet::NO_TARGET ||
+            (ship >= 0 && (size_t)ship < ships && loaded.targets[ship] == (int)h);
+    }
+    for (size_t h = 0; consistent && h < houseCount; h++) {
+        consistent = houses[h].houseType >= 0 && houses[h].houseType <= 2;
+    }
+    if (!consistent) {
+        std::cout << "Failed to load snapshot " << path << ": inconsistent data" << std::endl;
+        return false;
+    }
+
+    airshipPosition = player.airshipPosition;
+    airshipRotation = player.airshipRotation;
+    airshipSpeed = player.airshipSpeed;
+    windTime = player.windTime;
+    deliveredPackages = player.deliveredPackages;
+    fleetDeliveries = player.fleetDeliveries;
+    totalHouses = player.totalHouses;
+    gameRng = player.gameRng;
+
+    world.clear();
+
+    fieldEntity = world.create();
+    world.add(fieldEntity, Transform{ glm::vec3(0.0f), 0.0f, glm::vec3(1.0f) });
+    world.add(fieldEntity, Renderable{ MESH_FIELD, field.baseColor, true });
+
+    playerAirship = world.create();
+    world.add(playerAirship, Transform{ airshipPosition, glm::radians(airshipRotation), glm::vec3(1.0f) });
+    world.add(playerAirship, Renderable{ MESH_AIRSHIP, airship.baseColor, true });
+
+    //     :      
+    world.storage<House>().reserve(houseCount);
+    for (size_t i = 0; i < houseCount; i++) {
+        House house = { houses[i].hasPackage != 0, houses[i].houseType };
+        Entity e = world.create();
+        world.add(e, Transform{ houses[i].position, houses[i].rotation, glm::vec3(1.0f) });
+        world.add(e, house);
+        world.add(e, Renderable{ MESH_HOUSE1 + house.houseType, house_color(house), true });
+    }
+
+    world.storage<TreeObject>().reserve(treeCount);
+    for (size_t i = 0; i < treeCount; i++) {
+        TreeObject treeData = { trees[i].windOffset, trees[i].treeHeight };
+        Entity e = world.create();
+        world.add(e, Transform{ trees[i].position, trees[i].rotation, glm::vec3(1.0f, treeData.treeHeight / 12.0f, 1.0f) });
+        world.add(e, treeData);
+        world.add(e, Renderable{ MESH_TREE, tree.baseColor, true });
+    }
+
+    world.storage<Rock>().reserve(rockCount);
+    for (size_t i = 0; i < rockCount; i++) {
+        Entity e = world.create();
+        world.add(e, Transform{ rocks[i].position, rocks[i].rotation, glm::vec3(1.0f) });
+        world.add(e, Rock{ rocks[i].variant });
+        world.add(e, Renderable{ MESH_ROCK, rock.baseColor, true });
+    }
+
+    packages.clear();
+    for (size_t i = 0; i < packageCount; i++) {
+        Package pkg;
+        pkg.transform = Transform{ flying[i].position, flying[i].rotation, glm::vec3(1.0f) };
+        pkg.velocity = flying[i].velocity;
+        pkg.rotationSpeed = flying[i].rotationSpeed;
+        pkg.fromPlayer = flying[i].fromPlayer != 0;
+        packages.create(pkg);
+    }
+
+    fleet.clear();
+    fleet.positions.swap(loaded.positions);
+    fleet.velocities.swap(loaded.velocities);
+    fleet.headings.swap(loaded.headings);
+    fleet.altitudes.swap(loaded.altitudes);
+    fleet.targets.swap(loaded.targets);
+    fleet.waypoints.swap(loaded.waypoints);
+    fleet.rngs.swap(loaded.rngs);
+    fleet.claimedBy.swap(loaded.claimedBy);
+    fleet.reclaimTimers.swap(loaded.reclaimTimers);
+    for (size_t i = 0; i < ships; i++) {
+        Entity e = world.create();
+        fleet.entities.push_back(e);
+        world.add(e, Transform{ fleet.positions[i], fleet.headings[i], glm::vec3(1.0f) });
+        world.add(e, Renderable{ MESH_AIRSHIP, fleetColors[i], true });
+    }
+    fleet.rebuild();
+    collect_fleet_houses();
+
+    build_colliders();
+    shadowCascades.invalidate();
+    minimap.invalidate();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Snapshot loaded from " << path << ": " << houseCount << " houses, " << treeCount << " trees, "
+        << rockCount << " rocks, " << packageCount << " packages, " << ships << " ships in " << ms << " ms" << std::endl;
+    return true;
+}
+
+void credit_delivery(const Package& pkg) {
+    if (pkg.fromPlayer) deliveredPackages++;
+    else fleetDeliveries++;
 }
 
 void update_physics(float deltaTime) {
     windTime += deltaTime;
 
     //  
-    for (auto& pkg : packages) {
-        if (!pkg.active) continue;
+    jobs.parallel_for(packages.size(), 256, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            Package& pkg = packages.at(i);
+            Transform& transform = pkg.transform;
 
-        pkg.position += pkg.velocity * deltaTime;
-        pkg.rotation += pkg.rotationSpeed * deltaTime;
+            transform.rotation += pkg.rotationSpeed * deltaTime;
+            landedFlags[i] = package_step(transform.position, pkg.velocity, deltaTime, landedItems[i]) ? 1 : 0;
+        }
+    });
+
+    //  :     i    
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    for (uint32_t i = packages.size(); i-- > 0;) {
+        if (!landedFlags[i]) continue;
+
+        glm::vec3 ground = packages.at(i).transform.position;
+        ground.y = 0.0f;
+
+        //       
+        ComponentArray<House>& houseStore = world.storage<House>();
+        if (landedItems[i] != INVALID_INDEX) {
+            Entity target = colliderEntities[landedItems[i]];
+            House* house = houseStore.tryGet(target);
+            if (house && !house->hasPackage) {
+                house->hasPackage = true;
+                world.get<Renderable>(target).color = house_color(*house);
+                credit_delivery(packages.at(i));
+                packages.destroy(packages.handle_at(i));
+                continue;
+            }
+        }
+
+        for (size_t h = 0; h < houseStore.size(); h++) {
+            House& house = houseStore.dense[h];
+            if (house.hasPackage) continue;
+
+            Entity houseEntity = houseStore.entities[h];
+            if (glm::distance(ground, transforms.get(houseEntity).position) < 20.0f) {
+                house.hasPackage = true;
+                world.get<Renderable>(houseEntity).color = house_color(house);
+                credit_delivery(packages.at(i));
+                break;
+            }
+        }
 
-        pkg.velocity.y -= 9.8f * deltaTime * 5.0f;
+        packages.destroy(packages.handle_at(i));
+    }
+}
 
-        //    
-        if (pkg.position.y <= 5.0f) {
-            pkg.active = false;
+//  ,     
+void gather_lights(float time) {
+    std::vector<PointLight>& lights = clusteredLights.lights;
+    lights.clear();
 
-            for (auto& house : houses) {
-                if (!house.hasPackage) {
-                    float distance = glm::distance(
-                        glm::vec3(pkg.position.x, 0, pkg.position.z),
-                        house.position
-                    );
+    const glm::vec3 windowColor = glm::vec3(1.0f, 0.75f, 0.4f) * 1.5f;
+    uint32_t index = 0;
+    world.each<House, Transform>([&](Entity, House& house, Transform& t) {
+        lights.push_back({ t.position + glm::vec3(0.0f, 4.0f, 6.0f), 18.0f, windowColor });
+        lights.push_back({ t.position + glm::vec3(0.0f, 4.0f, -6.0f), 18.0f, windowColor });
 
-                    if (distance < 20.0f) {
-                        house.hasPackage = true;
-                        deliveredPackages++;
-                        break;
-                    }
+        //   ,   
+        if (house.hasPackage) {
+            lights.push_back({ t.position + glm::vec3(0.0f, 14.0f, 0.0f), 25.0f, glm::vec3(0.2f, 1.0f, 0.3f) });
+        }
+        else {
+            float pulse = 1.5f + 0.8f * sinf(time * 4.0f + index * 0.7f);
+            lights.push_back({ t.position + glm::vec3(0.0f, 14.0f, 0.0f), 45.0f, glm::vec3(1.0f, 0.15f, 0.1f) * pulse });
+        }
+        index++;
+    });
+
+    float rotation = glm::radians(airshipRotation);
+    glm::vec3 side(cosf(rotation), 0.0f, -sinf(rotation));
+    lights.push_back({ airshipPosition + glm::vec3(0.0f, -8.0f, 0.0f), 80.0f, glm::vec3(1.2f) });
+    lights.push_back({ airshipPosition - side * 11.0f, 20.0f, glm::vec3(1.5f, 0.1f, 0.1f) });
+    lights.push_back({ airshipPosition + side * 11.0f, 20.0f, glm::vec3(0.1f, 1.5f, 0.2f) });
+}
+
+//     LOD   storage<Renderable>()
+std::vector<uint8_t> visibleFlags;
+std::vector<uint8_t> drawMeshes;
+std::vector<uint32_t> chunkCounts;
+const uint32_t INSTANCE_CHUNK = 1024;
+
+struct Occluder {
+    float size;
+    uint32_t item;
+};
+std::vector<Occluder> occluders;
+std::atomic<uint32_t> occludedCount{ 0 };
+double occlusionTestMs = 0.0;
+
+//          .
+// BVH  ,     .
+void rasterize_occluders(const glm::mat4& viewProjection, const glm::vec3& viewPosition) {
+    Frustum frustum;
+    frustum.from_matrix(viewProjection);
+
+    occluders.clear();
+    for (uint32_t i = 0; i < (uint32_t)sceneBvh.boxes.size(); i++) {
+        if (!(sceneBvh.masks[i] & COLLIDE_STATIC)) continue;
+
+        const Aabb& box = sceneBvh.boxes[i];
+        glm::vec3 center = box.center();
+        float radius = glm::length(box.max - box.min) * 0.5f;
+        if (!frustum.sphere_visible(center, radius)) continue;
+
+        float size = radius / std::max(glm::distance(center, viewPosition), 1.0f);
+        if (size >= OCCLUDER_MIN_SIZE) occluders.push_back({ size, i });
+    }
+
+    if (occluders.size() > MAX_OCCLUDERS) {
+        std::nth_element(occluders.begin(), occluders.begin() + MAX_OCCLUDERS, occluders.end(),
+            [](const Occluder& a, const Occluder& b) { return a.size > b.size; });
+        occluders.resize(MAX_OCCLUDERS);
+    }
+
+    occlusionBuffer.begin(viewProjection);
+    for (const Occluder& occluder : occluders) {
+        occlusionBuffer.draw_box(occluderBoxes[occluder.item], occluderMatrices[occluder.item]);
+    }
+}
+
+//      
+bool instance_visible(const Frustum& frustum, const GameObject& mesh, const glm::mat4& m) {
+    glm::vec3 center = glm::vec3(m * glm::vec4(mesh.boundCenter, 1.0f));
+    float scale = std::max(glm::length(glm::vec3(m[0])),
+        std::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+
+    //     
+    return frustum.sphere_visible(center, mesh.boundRadius * scale + 1.0f);
+}
+
+void cull_renderables(const Frustum& frustum) {
+    ComponentArray<Renderable>& renderables = world.storage<Renderable>();
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    visibleFlags.resize(renderables.size());
+
+    jobs.parallel_for((uint32_t)renderables.size(), 512, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const GameObject& mesh = *meshes[renderables.dense[i].mesh];
+            const glm::mat4& m = transformSystem.matrix(transforms, renderables.entities[i]);
+            visibleFlags[i] = instance_visible(frustum, mesh, m) ? 1 : 0;
+        }
+    });
+
+    occludedCount = 0;
+    occlusionTestMs = 0.0;
+    if (!occlusionEnabled) return;
+
+    auto start = std::chrono::steady_clock::now();
+    jobs.parallel_for((uint32_t)renderables.size(), 512, [&](uint32_t begin, uint32_t end) {
+        uint32_t occluded = 0;
+        for (uint32_t i = begin; i < end; i++) {
+            if (!visibleFlags[i]) continue;
+
+            const GameObject& mesh = *meshes[renderables.dense[i].mesh];
+            const glm::mat4& m = transformSystem.matrix(transforms, renderables.entities[i]);
+            Aabb box = transform_aabb(mesh.boundsMin - glm::vec3(1.0f), mesh.boundsMax + glm::vec3(1.0f), m);
+            if (!occlusionBuffer.box_visible(box)) {
+                visibleFlags[i] = 0;
+                occluded++;
+            }
+        }
+        occludedCount += occluded;
+    });
+    occlusionTestMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void select_lods(const glm::vec3& viewPosition) {
+    ComponentArray<Renderable>& renderables = world.storage<Renderable>();
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    drawMeshes.resize(renderables.size());
+
+    jobs.parallel_for((uint32_t)renderables.size(), 512, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            int mesh = renderables.dense[i].mesh;
+            if (mesh == MESH_TREE) {
+                const glm::mat4& m = transformSystem.matrix(transforms, renderables.entities[i]);
+                if (glm::distance(glm::vec3(m[3]), viewPosition) > TREE_LOD_DISTANCE) {
+                    mesh = MESH_TREE_LOW;
                 }
             }
+            drawMeshes[i] = (uint8_t)mesh;
+        }
+    });
+}
+
+//  -  :   , 
+//       
+void build_instance_lists(const Frustum& frustum) {
+    ComponentArray<Renderable>& renderables = world.storage<Renderable>();
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    ComponentArray<TreeObject>& trees = world.storage<TreeObject>();
+
+    uint32_t count = (uint32_t)renderables.size();
+    uint32_t chunks = (count + INSTANCE_CHUNK - 1) / INSTANCE_CHUNK;
+    chunkCounts.assign((size_t)chunks * MESH_COUNT, 0);
+
+    jobs.parallel_for(chunks, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; c++) {
+            uint32_t* counts = &chunkCounts[(size_t)c * MESH_COUNT];
+            for (uint32_t i = c * INSTANCE_CHUNK; i < std::min(count, (c + 1) * INSTANCE_CHUNK); i++) {
+                if (visibleFlags[i]) counts[drawMeshes[i]]++;
+            }
+        }
+    });
+
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+        uint32_t offset = 0;
+        for (uint32_t c = 0; c < chunks; c++) {
+            uint32_t n = chunkCounts[(size_t)c * MESH_COUNT + mesh];
+            chunkCounts[(size_t)c * MESH_COUNT + mesh] = offset;
+            offset += n;
         }
+        instanceLists[mesh].resize(offset);
+    }
+
+    //         
+    const GameObject& packageMesh = *meshes[MESH_PACKAGE];
+    for (uint32_t i = 0; i < packages.size(); i++) {
+        const Transform& t = packages.at(i).transform;
+        if (!frustum.sphere_visible(t.position + packageMesh.boundCenter, packageMesh.boundRadius)) continue;
+
+        InstanceData instance;
+        instance.model = transform_matrix(t);
+        instance.color = glm::vec4(packageMesh.baseColor, 0.0f);
+        instance.params = glm::vec4(0.0f);
+        instanceLists[MESH_PACKAGE].push_back(instance);
+    }
+
+    playerInstanceIndex = -1;
+
+    //      
+    if (aimMode && aimImpactValid) {
+        InstanceData marker;
+        marker.model = transform_matrix(Transform{ aimImpact + glm::vec3(0, 0.1f, 0), 0.0f, glm::vec3(3.0f, 0.2f, 3.0f) });
+        marker.color = glm::vec4(1.0f, 0.1f, 0.1f, 0.0f);
+        marker.params = glm::vec4(0.0f);
+        instanceLists[MESH_PACKAGE].push_back(marker);
     }
 
-    packages.erase(
-        std::remove_if(packages.begin(), packages.end(),
-            [](const Package& p) { return !p.active; }),
-        packages.end()
-    );
+    jobs.parallel_for(chunks, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; c++) {
+            uint32_t* offsets = &chunkCounts[(size_t)c * MESH_COUNT];
+            for (uint32_t i = c * INSTANCE_CHUNK; i < std::min(count, (c + 1) * INSTANCE_CHUNK); i++) {
+                if (!visibleFlags[i]) continue;
+
+                Entity e = renderables.entities[i];
+                const Renderable& r = renderables.dense[i];
+
+                if (e == playerAirship) playerInstanceIndex = (int)offsets[drawMeshes[i]];
+                InstanceData& instance = instanceLists[drawMeshes[i]][offsets[drawMeshes[i]]++];
+                instance.model = transformSystem.matrix(transforms, e);
+                instance.color = glm::vec4(r.color, r.useTexture ? 1.0f : 0.0f);
+                instance.params = glm::vec4(0.0f);
+
+                if (const TreeObject* treeObj = trees.tryGet(e)) {
+                    instance.params = glm::vec4(treeObj->treeHeight, treeObj->windOffset, 1.0f, 0.0f);
+                }
+            }
+        }
+    });
 }
 
-void render_object(const GameObject& obj, const glm::mat4& model,
-    bool useTexture = true, bool useNormalMap = false) {
+bool is_static_caster(int mesh) {
+    return mesh == MESH_ROCK || mesh == MESH_HOUSE1 || mesh == MESH_HOUSE2 || mesh == MESH_HOUSE3;
+}
+
+//     .    
+// ,      ;  (),
+//    -  .
+void build_shadow_casters() {
+    ComponentArray<Renderable>& renderables = world.storage<Renderable>();
+    ComponentArray<Transform>& transforms = world.storage<Transform>();
+    ComponentArray<TreeObject>& trees = world.storage<TreeObject>();
+    const GameObject& packageMesh = *meshes[MESH_PACKAGE];
+
+    jobs.parallel_for(ShadowCascades::CASCADES, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; c++) {
+            Frustum frustum;
+            frustum.from_matrix(shadowCascades.matrices[c]);
+            bool rebuildStatic = shadowCascades.staticDirty[c];
+
+            for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+                shadowDynamic[c][mesh].clear();
+                if (rebuildStatic) shadowStatic[c][mesh].clear();
+            }
+
+            for (uint32_t i = 0; i < renderables.size(); i++) {
+                int mesh = renderables.dense[i].mesh;
+                bool isStatic = is_static_caster(mesh);
+                if (mesh == MESH_FIELD || (isStatic && !rebuildStatic)) continue;
+
+                Entity e = renderables.entities[i];
+                const glm::mat4& m = transformSystem.matrix(transforms, e);
+                if (!instance_visible(frustum, *meshes[mesh], m)) continue;
+
+                InstanceData instance;
+                instance.model = m;
+                instance.color = glm::vec4(0.0f);
+                instance.params = glm::vec4(0.0f);
+                if (const TreeObject* treeObj = trees.tryGet(e)) {
+                    instance.params = glm::vec4(treeObj->treeHeight, treeObj->windOffset, 1.0f, 0.0f);
+                    if (c > 0) mesh = MESH_TREE_LOW;
+                }
+                (isStatic ? shadowStatic : shadowDynamic)[c][mesh].push_back(instance);
+            }
+
+            for (uint32_t i = 0; i < packages.size(); i++) {
+                const Transform& t = packages.at(i).transform;
+                if (!frustum.sphere_visible(t.position + packageMesh.boundCenter, packageMesh.boundRadius)) continue;
+                shadowDynamic[c][MESH_PACKAGE].push_back({ transform_matrix(t), glm::vec4(0.0f), glm::vec4(0.0f) });
+            }
+        }
+    });
+}
+
+//     VAO  offset   
+void bind_instance_attributes(size_t offset) {
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer);
+    for (int i = 0; i < 4; i++) {
+        glVertexAttribPointer(6 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(offset + offsetof(InstanceData, model) + sizeof(glm::vec4) * i));
+    }
+    glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, color)));
+    glVertexAttribPointer(11, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, params)));
+}
+
+//  FrameData   -    
+//  .  false,    .
+template <typename Func>
+void for_each_instance_list(Func func) {
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+        func(instanceLists[mesh], instanceOffsets[mesh]);
+    }
+    for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+        for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+            func(shadowDynamic[c][mesh], shadowDynamicOffsets[c][mesh]);
+            if (shadowCascades.staticDirty[c]) func(shadowStatic[c][mesh], shadowStaticOffsets[c][mesh]);
+        }
+    }
+}
+
+bool upload_frame_data(const FrameData& frameData) {
+    size_t frameDataSize = StreamBuffer::align(sizeof(FrameData), streamBuffer.alignment);
+    size_t bytes = frameDataSize;
+    for_each_instance_list([&](const std::vector<InstanceData>& list, size_t&) {
+        bytes += list.size() * sizeof(InstanceData);
+    });
+
+    uint8_t* mapped = streamBuffer.map(bytes);
+    if (!mapped) return false;
+
+    memcpy(mapped, &frameData, sizeof(FrameData));
+    size_t offset = frameDataSize;
+    for_each_instance_list([&](const std::vector<InstanceData>& list, size_t& listOffset) {
+        size_t size = list.size() * sizeof(InstanceData);
+        if (size > 0) memcpy(mapped + offset, list.data(), size);
+        listOffset = streamBuffer.region_offset() + offset;
+        offset += size;
+    });
+    streamBuffer.unmap();
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, streamBuffer.buffer,
+        (GLintptr)streamBuffer.region_offset(), sizeof(FrameData));
+    return true;
+}
+
+void render_instances(const GameObject& obj, size_t count, size_t offset) {
+    if (count == 0) return;
 
     glBindVertexArray(obj.vao);
+    bind_instance_attributes(offset);
 
-    if (useTexture && obj.texture != 0) {
+    if (obj.texture != 0) {
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, obj.texture);
     }
 
-    if (useNormalMap && obj.normalMap != 0) {
+    if (obj.normalMap != 0) {
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, obj.normalMap);
     }
 
-    glDrawArrays(GL_TRIANGLES, 0, obj.vertexCount);
+    glDrawElementsInstanced(GL_TRIANGLES, obj.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)count);
     glBindVertexArray(0);
 }
 
+//   .    
+// ,       
+//   .
+void steer_airship(GLFWwindow* window) {
+    static double lastSample = glfwGetTime();
+    double now = glfwGetTime();
+    float deltaTime = std::min(float(now - lastSample), 0.1f);
+    lastSample = now;
+
+    float moveSpeed = airshipSpeed * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+        airshipPosition.z -= moveSpeed * cos(glm::radians(airshipRotation));
+        airshipPosition.x -= moveSpeed * sin(glm::radians(airshipRotation));
+    }
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+        airshipPosition.z += moveSpeed * cos(glm::radians(airshipRotation));
+        airshipPosition.x += moveSpeed * sin(glm::radians(airshipRotation));
+    }
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+        airshipRotation += 60.0f * deltaTime;
+    }
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+        airshipRotation -= 60.0f * deltaTime;
+    }
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
+        airshipPosition.y += moveSpeed;
+    }
+    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
+        airshipPosition.y -= moveSpeed;
+    }
+
+    if (airshipPosition.y < 30.0f) airshipPosition.y = 30.0f;
+    if (airshipPosition.y > 300.0f) airshipPosition.y = 300.0f;
+}
+
+void place_camera() {
+    if (aimMode) {
+        camera.position = airshipPosition + glm::vec3(0, -15, 0);
+        camera.yaw = airshipRotation;
+        camera.pitch = -10.0f;
+    }
+    else {
+        float camDistance = 80.0f;
+        float camHeight = 40.0f;
+
+        camera.position = airshipPosition +
+            glm::vec3(
+                sin(glm::radians(airshipRotation)) * camDistance,
+                camHeight,
+                cos(glm::radians(airshipRotation)) * camDistance
+            );
+        camera.yaw = airshipRotation + 180.0f;
+        camera.pitch = -25.0f;
+    }
+}
+
+//   :    ,   
+void build_minimap_markers() {
+    std::vector<Minimap::Marker>& markers = minimap.markers;
+    markers.clear();
+    world.each<TreeObject, Transform>([&](Entity, TreeObject&, Transform& t) {
+        markers.push_back({ glm::vec4(t.position.x, t.position.z, 2.5f, 1.0f), glm::vec4(0.2f, 0.45f, 0.15f, 1.0f) });
+    });
+    world.each<Rock, Transform>([&](Entity, Rock&, Transform& t) {
+        markers.push_back({ glm::vec4(t.position.x, t.position.z, 3.0f, 1.0f), glm::vec4(0.45f, 0.45f, 0.45f, 1.0f) });
+    });
+    world.each<House, Transform>([&](Entity, House& house, Transform& t) {
+        glm::vec4 color = house.hasPackage ? glm::vec4(0.15f, 0.7f, 0.2f, 1.0f) : glm::vec4(0.85f, 0.15f, 0.1f, 1.0f);
+        markers.push_back({ glm::vec4(t.position.x, t.position.z, 7.0f, 0.0f), color });
+    });
+    for (size_t i = 0; i < fleet.size(); i++) {
+        markers.push_back({ glm::vec4(fleet.positions[i].x, fleet.positions[i].z, 3.0f, 1.0f), glm::vec4(0.2f, 0.3f, 0.8f, 1.0f) });
+    }
+}
+
+//  ,     
+void track_frame_resources() {
+    gpuMemory.track(GpuMemory::BUFFER, streamBuffer.buffer, "stream buffer", "frame ring", "mixed",
+        streamBuffer.regionSize * StreamBuffer::FRAMES);
+    gpuMemory.track(GpuMemory::BUFFER, 0, "clustered lights", "light/cluster/index TBOs", "mixed",
+        ClusteredLights::MAX_LIGHTS * 2 * sizeof(glm::vec4) + ClusteredLights::CLUSTER_COUNT * 2 * sizeof(uint32_t) +
+        std::max<size_t>(clusteredLights.indexCount, 1) * sizeof(uint32_t));
+    gpuMemory.track(GpuMemory::TEXTURE, shadowCascades.depthTexture, "shadow cascades", "live + static arrays", "D32F",
+        2 * (size_t)ShadowCascades::SIZE * ShadowCascades::SIZE * ShadowCascades::CASCADES * 4);
+    size_t targetPixels = (size_t)dynamicResolution.windowWidth * dynamicResolution.windowHeight;
+    gpuMemory.track(GpuMemory::TEXTURE, 0, "scene target", "color", "RGBA8", targetPixels * 4);
+    gpuMemory.track(GpuMemory::RENDERBUFFER, 0, "scene target", "depth", "D24", targetPixels * 4);
+    gpuMemory.track(GpuMemory::TEXTURE, minimap.texture_id(), "minimap", "cached map", "RGBA8",
+        (size_t)Minimap::SIZE * Minimap::SIZE * 4);
+    if (frameCapture.active()) {
+        gpuMemory.track(GpuMemory::BUFFER, 0, "frame capture", "PBO ring", "RGBA8",
+            (size_t)FrameCapture::PBOS * dynamicResolution.windowWidth * dynamicResolution.windowHeight * 4);
+    }
+    else {
+        gpuMemory.untrack(GpuMemory::BUFFER, 0, "frame capture", "PBO ring");
+    }
+}
+
+//     CAPTURE: raw -  ,  PNG
+void toggle_capture(int width, int height, const char* mode) {
+    if (frameCapture.active()) {
+        frameCapture.stop();
+    }
+    else {
+        bool raw = mode && strcmp(mode, "raw") == 0;
+        frameCapture.start(width, height, raw ? FrameCapture::RAW_VIDEO : FrameCapture::PNG_SEQUENCE, CAPTURE_PREFIX);
+    }
+    track_frame_resources();
+}
+
+//        -
+//    ,     GPU
+void request_texture_sizes(const glm::vec3& viewPosition, const glm::mat4& projection, int screenHeight) {
+    float pixelsPerUnit = projection[1][1] * 0.5f * screenHeight;
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+        const GameObject& obj = *meshes[mesh];
+        if (obj.texture == 0 && obj.normalMap == 0) continue;
+
+        float largest = 0.0f;
+        for (const InstanceData& instance : instanceLists[mesh]) {
+            float scale = std::max(glm::length(glm::vec3(instance.model[0])),
+                std::max(glm::length(glm::vec3(instance.model[1])), glm::length(glm::vec3(instance.model[2]))));
+            float radius = obj.boundRadius * scale;
+            glm::vec3 center = glm::vec3(instance.model * glm::vec4(obj.boundCenter, 1.0f));
+            float distance = std::max(glm::distance(center, viewPosition) - radius, 0.1f);
+            largest = std::max(largest, 2.0f * radius / distance * pixelsPerUnit);
+        }
+        if (largest <= 0.0f) continue;
+
+        if (obj.texture) textureStreamer.request_size(obj.texture, largest);
+        if (obj.normalMap) textureStreamer.request_size(obj.normalMap, largest);
+    }
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    (void)window;
+    (void)width;
+    (void)height;
+    framebufferResized = true;
+}
+
+glm::mat4 make_projection(int width, int height) {
+    float aspect = height > 0 ? (float)width / (float)height : 1.0f;
+    return glm::perspective(glm::radians(45.0f), aspect, 0.1f, 10000.0f);
+}
+
 int main() {
+    gpuMemory.budgetBytes = GPU_MEMORY_BUDGET_MB << 20;
+    if (const char* budget = getenv("GPU_BUDGET_MB")) {
+        int megabytes = std::max(0, atoi(budget));
+        if (megabytes > 0) gpuMemory.budgetBytes = (size_t)megabytes << 20;
+        else std::cout << "Warning: invalid GPU_BUDGET_MB \"" << budget << "\", using " << GPU_MEMORY_BUDGET_MB << " MB" << std::endl;
+    }
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -654,7 +1795,8 @@ int main() {
     }
 
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    framePacer.set_mode(FramePacer::VSYNC);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
     if (glewInit() != GLEW_OK) {
         std::cerr << "Failed to initialize GLEW" << std::endl;
@@ -676,19 +1818,46 @@ int main() {
         return -1;
     }
 
+    unsigned int shadowProgram = CreateShadowProgram();
+    if (shadowProgram == 0) {
+        std::cerr << "Failed to create shadow program" << std::endl;
+        return -1;
+    }
+    int shadowCascadeLoc = glGetUniformLocation(shadowProgram, "shadowCascade");
+
+    unsigned int upscaleProgram = CreateUpscaleProgram();
+    if (upscaleProgram == 0) {
+        std::cerr << "Failed to create upscale program" << std::endl;
+        return -1;
+    }
+    int uvScaleLoc = glGetUniformLocation(upscaleProgram, "uvScale");
+    glUseProgram(upscaleProgram);
+    glUniform1i(glGetUniformLocation(upscaleProgram, "sceneColor"), 0);
+
     glUseProgram(shaderProgram);
     std::cout << "Shader program created successfully" << std::endl;
 
     glUniform1i(glGetUniformLocation(shaderProgram, "texture0"), 0);
     glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 1);
 
-    generate_random_positions();
+    unsigned int frameDataIndex = glGetUniformBlockIndex(shaderProgram, "FrameData");
+    if (frameDataIndex == GL_INVALID_INDEX) std::cout << "Warning: FrameData uniform block not found" << std::endl;
+    else glUniformBlockBinding(shaderProgram, frameDataIndex, FRAME_DATA_BINDING);
+    glUniformBlockBinding(shadowProgram, glGetUniformBlockIndex(shadowProgram, "FrameData"), FRAME_DATA_BINDING);
+
+    //    ,    
+    streamBuffer.create(sizeof(FrameData) + 4096 * sizeof(InstanceData));
+
+    jobs.start();
+    textureStreamer.start(std::max(1u, std::thread::hardware_concurrency() / 4));
+    std::cout << "Job system: " << jobs.worker_count() << " workers" << std::endl;
 
     std::cout << "Creating game objects..." << std::endl;
     try {
-        airship = create_object("AIRSHIP", "textures/metall.png", "textures/normalmap.png", glm::vec3(0.8f, 0.2f, 0.2f));
+        airship = create_object("AIRSHIP", "textures/metall.png", "textures/normalmap.jpg", glm::vec3(0.8f, 0.2f, 0.2f));
         field = create_object("FIELD", "textures/snow.png", "", glm::vec3(1.0f, 1.0f, 1.0f));
         tree = create_object("TREE", "textures/wood.png", "", glm::vec3(0.3f, 0.5f, 0.1f));
+        treeLow = create_object("TREE_LOW", "textures/wood.png", "", glm::vec3(0.3f, 0.5f, 0.1f));
         rock = create_object("ROCK", "textures/stone.png", "", glm::vec3(0.5f, 0.5f, 0.5f));
         house1 = create_object("HOUSE1", "textures/wood.png", "", glm::vec3(0.7f, 0.5f, 0.3f));
         house2 = create_object("HOUSE2", "textures/wood.png", "", glm::vec3(0.8f, 0.4f, 0.3f));
@@ -696,86 +1865,142 @@ int main() {
         packageObj = create_object("PACKAGE", "", "", glm::vec3(0.9f, 0.8f, 0.1f));
 
         std::cout << "All objects created successfully" << std::endl;
-        std::cout << "Airship normal map: " << (airship.normalMap != 0 ? "Loaded" : "Not loaded") << std::endl;
+        std::cout << "Airship normal map: " << (airship.normalMap != 0 ? "Streaming" : "Not loaded") << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "Error creating objects: " << e.what() << std::endl;
         return -1;
     }
 
+    generate_random_positions();
+    build_colliders();
+
+    int fleetSize = FLEET_SIZE;
+    if (const char* size = getenv("FLEET_SIZE")) fleetSize = std::max(0, atoi(size));
+    spawn_fleet(fleetSize);
+    //  :      
+    if (const char* path = getenv("LOAD_SNAPSHOT")) load_world_snapshot(path);
+
     camera.position = glm::vec3(0, 150, -100);
     camera.yaw = 0.0f;
     camera.pitch = -30.0f;
 
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projectionLoc = glGetUniformLocation(shaderProgram, "projection");
-    int lightDirLoc = glGetUniformLocation(shaderProgram, "lightDir");
-    int useTextureLoc = glGetUniformLocation(shaderProgram, "useTexture");
     int useNormalMapLoc = glGetUniformLocation(shaderProgram, "useNormalMap");
-    int baseColorLoc = glGetUniformLocation(shaderProgram, "baseColor");
-    int timeLoc = glGetUniformLocation(shaderProgram, "time");
-    int windEffectLoc = glGetUniformLocation(shaderProgram, "windEffect");
-    int windStrengthLoc = glGetUniformLocation(shaderProgram, "windStrength");
-    int windFrequencyLoc = glGetUniformLocation(shaderProgram, "windFrequency");
-    int treeHeightLoc = glGetUniformLocation(shaderProgram, "treeHeight");
-    int windOffsetLoc = glGetUniformLocation(shaderProgram, "windOffset");
-
-    if (modelLoc == -1) std::cout << "Warning: model uniform not found" << std::endl;
-    if (viewLoc == -1) std::cout << "Warning: view uniform not found" << std::endl;
-    if (projectionLoc == -1) std::cout << "Warning: projection uniform not found" << std::endl;
-    if (lightDirLoc == -1) std::cout << "Warning: lightDir uniform not found" << std::endl;
-    if (baseColorLoc == -1) std::cout << "Warning: baseColor uniform not found" << std::endl;
-
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 10000.0f);
-    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
+    //      2-4
+    glUniform1i(glGetUniformLocation(shaderProgram, "lightData"), 2);
+    glUniform1i(glGetUniformLocation(shaderProgram, "clusterData"), 3);
+    glUniform1i(glGetUniformLocation(shaderProgram, "lightIndices"), 4);
+    clusteredLights.create();
+
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    dynamicResolution.create(framebufferWidth, framebufferHeight);
+    glm::mat4 projection = make_projection(framebufferWidth, framebufferHeight);
     glm::vec3 lightDir = glm::normalize(glm::vec3(0.5f, -1.0f, 0.5f));
-    glUniform3fv(lightDirLoc, 1, glm::value_ptr(lightDir));
+
+    //     5
+    glUniform1i(glGetUniformLocation(shaderProgram, "shadowMap"), 5);
+    glUniform1i(glGetUniformLocation(shaderProgram, "shadowCascade"), -1);
+    shadowCascades.create(lightDir);
+
+    snowfall.flakeCount = SNOW_FLAKES;
+    if (const char* flakes = getenv("SNOW_FLAKES")) snowfall.flakeCount = std::max(0, atoi(flakes));
+    if (!snowfall.create(FRAME_DATA_BINDING)) std::cout << "Warning: snow program failed, snow is disabled" << std::endl;
+
+    minimap.worldHalfExtent = WORLD_HALF_EXTENT;
+    minimap.create();
+    int minimapDelivered = -1;
+
+    //  :  ->  -> ( || LOD) -> -
+    float frameDelta = 0.0f;
+    float frameTime = 0.0f;
+    glm::mat4 frameView(1.0f);
+    glm::mat4 viewProjection(1.0f);
+    Frustum frustum;
+
+    auto fleetTask = [&]() { update_fleet(frameDelta); };
+    auto physicsTask = [&]() { update_physics(frameDelta); };
+    auto transformTask = [&]() { transformSystem.update(world.storage<Transform>(), &jobs); };
+    auto cullingTask = [&]() {
+        frustum.from_matrix(viewProjection);
+        cull_renderables(frustum);
+    };
+    auto occluderTask = [&]() {
+        if (occlusionEnabled) rasterize_occluders(viewProjection, camera.position);
+    };
+    auto lodTask = [&]() { select_lods(camera.position); };
+    auto shadowTask = [&]() { build_shadow_casters(); };
+    auto lightTask = [&]() {
+        gather_lights(frameTime);
+        clusteredLights.assign(frameView, projection);
+    };
+    auto instanceTask = [&]() { build_instance_lists(frustum); };
+
+    TaskGraph frameGraph;
+    uint32_t fleetNode = frameGraph.add("fleet", &fleetTask);
+    uint32_t physicsNode = frameGraph.add("physics", &physicsTask);
+    uint32_t transformNode = frameGraph.add("transforms", &transformTask);
+    uint32_t occluderNode = frameGraph.add("occluders", &occluderTask);
+    uint32_t cullingNode = frameGraph.add("culling", &cullingTask);
+    uint32_t lodNode = frameGraph.add("lod", &lodTask);
+    uint32_t lightNode = frameGraph.add("lights", &lightTask);
+    uint32_t shadowNode = frameGraph.add("shadow casters", &shadowTask);
+    uint32_t instanceNode = frameGraph.add("instances", &instanceTask);
+    frameGraph.depend(fleetNode, physicsNode);
+    frameGraph.depend(physicsNode, transformNode);
+    frameGraph.depend(transformNode, cullingNode);
+    frameGraph.depend(occluderNode, cullingNode);
+    frameGraph.depend(transformNode, lodNode);
+    frameGraph.depend(physicsNode, lightNode);
+    frameGraph.depend(transformNode, shadowNode);
+    frameGraph.depend(cullingNode, instanceNode);
+    frameGraph.depend(lodNode, instanceNode);
 
     double lastTime = glfwGetTime();
+    if (const char* mode = getenv("CAPTURE")) toggle_capture(framebufferWidth, framebufferHeight, mode);
+    track_frame_resources();
+    gpuMemory.report();
+
     std::cout << "Entering main loop..." << std::endl;
 
     while (!glfwWindowShouldClose(window)) {
+        //     ,      
+        framePacer.wait();
+        glfwPollEvents();
+        framePacer.input_sampled();
+
+        if (framebufferResized) {
+            framebufferResized = false;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            //  :        
+            if (framebufferWidth == 0 || framebufferHeight == 0) {
+                framebufferResized = true;
+                glfwWaitEvents();
+                lastTime = glfwGetTime();
+                continue;
+            }
+            dynamicResolution.resize(framebufferWidth, framebufferHeight);
+            //    :    
+            if (frameCapture.active()) frameCapture.stop();
+            track_frame_resources();
+            projection = make_projection(framebufferWidth, framebufferHeight);
+        }
+
+        uint64_t frameAllocations = heap_allocation_count();
         double currentTime = glfwGetTime();
         float deltaTime = float(currentTime - lastTime);
         lastTime = currentTime;
 
-        update_physics(deltaTime);
-
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
 
-        float moveSpeed = airshipSpeed * deltaTime;
-
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-            airshipPosition.z -= moveSpeed * cos(glm::radians(airshipRotation));
-            airshipPosition.x -= moveSpeed * sin(glm::radians(airshipRotation));
-        }
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-            airshipPosition.z += moveSpeed * cos(glm::radians(airshipRotation));
-            airshipPosition.x += moveSpeed * sin(glm::radians(airshipRotation));
-        }
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-            airshipRotation += 60.0f * deltaTime;
-        }
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-            airshipRotation -= 60.0f * deltaTime;
-        }
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-            airshipPosition.y += moveSpeed;
-        }
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
-            airshipPosition.y -= moveSpeed;
-        }
-
-        if (airshipPosition.y < 30.0f) airshipPosition.y = 30.0f;
-        if (airshipPosition.y > 300.0f) airshipPosition.y = 300.0f;
+        steer_airship(window);
 
         static bool spacePressed = false;
         if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS && !spacePressed) {
-            if (packages.size() < NUM_PACKAGES_MAX) {
+            if (!packages.full() && player_packages_in_flight() < NUM_PACKAGES_MAX) {
                 drop_package();
                 std::cout << "Package dropped!" << std::endl;
             }
@@ -793,130 +2018,279 @@ int main() {
             cPressed = false;
         }
 
-        if (aimMode) {
-            camera.position = airshipPosition + glm::vec3(0, -15, 0);
-            camera.yaw = airshipRotation;
-            camera.pitch = -10.0f;
+        static bool oPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !oPressed) {
+            occlusionEnabled = !occlusionEnabled;
+            std::cout << "Occlusion culling: " << (occlusionEnabled ? "on" : "off") << std::endl;
+            oPressed = true;
         }
-        else {
-            float camDistance = 80.0f;
-            float camHeight = 40.0f;
-
-            camera.position = airshipPosition +
-                glm::vec3(
-                    sin(glm::radians(airshipRotation)) * camDistance,
-                    camHeight,
-                    cos(glm::radians(airshipRotation)) * camDistance
-                );
-            camera.yaw = airshipRotation + 180.0f;
-            camera.pitch = -25.0f;
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE) {
+            oPressed = false;
         }
 
-        glm::mat4 view = camera.GetView();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        static bool gPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gPressed) {
+            track_frame_resources();
+            gpuMemory.report();
+            gPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE) {
+            gPressed = false;
+        }
 
-        glUniform1f(timeLoc, (float)currentTime);
+        static bool vPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !vPressed) {
+            framePacer.set_mode((FramePacer::Mode)((framePacer.mode + 1) % FramePacer::MODE_COUNT));
+            std::cout << "Frame pacing: " << framePacer.mode_name() << std::endl;
+            vPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE) {
+            vPressed = false;
+        }
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        static bool nPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS && !nPressed) {
+            if (snowfall.available()) {
+                snowfall.enabled = !snowfall.enabled;
+                std::cout << "Snow: " << (snowfall.enabled ? "on" : "off") << std::endl;
+            }
+            else {
+                std::cout << "Snow is unavailable" << std::endl;
+            }
+            nPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_N) == GLFW_RELEASE) {
+            nPressed = false;
+        }
 
-        glUniform1i(useTextureLoc, 1);
-        glUniform1i(useNormalMapLoc, 0);
-        glUniform1i(windEffectLoc, 0);
-        glUniform3fv(baseColorLoc, 1, glm::value_ptr(field.baseColor));
+        static bool f12Pressed = false;
+        if (glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS && !f12Pressed) {
+            toggle_capture(framebufferWidth, framebufferHeight, getenv("CAPTURE"));
+            f12Pressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F12) == GLFW_RELEASE) {
+            f12Pressed = false;
+        }
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        render_object(field, model);
+        static bool f5Pressed = false;
+        if (glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS && !f5Pressed) {
+            save_world_snapshot(SNAPSHOT_PATH);
+            f5Pressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F5) == GLFW_RELEASE) {
+            f5Pressed = false;
+        }
 
-        glUniform1i(windEffectLoc, 1);  
-        glUniform1f(windStrengthLoc, 0.2f);  
-        glUniform1f(windFrequencyLoc, 1.8f); 
-        glUniform1i(useTextureLoc, 1);
-        glUniform3fv(baseColorLoc, 1, glm::value_ptr(tree.baseColor));
+        static bool f9Pressed = false;
+        if (glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS && !f9Pressed) {
+            load_world_snapshot(SNAPSHOT_PATH);
+            f9Pressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F9) == GLFW_RELEASE) {
+            f9Pressed = false;
+        }
 
-        for (const auto& treeObj : treePositions) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, treeObj.position);
-            model = glm::scale(model, glm::vec3(1.0f, treeObj.treeHeight / 12.0f, 1.0f)); 
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        place_camera();
 
-            glUniform1f(treeHeightLoc, treeObj.treeHeight);
-            glUniform1f(windOffsetLoc, treeObj.windOffset);
+        glm::mat4 view = camera.GetView();
 
-            render_object(tree, model);
-        }
+        Transform& airshipTransform = world.get<Transform>(playerAirship);
+        airshipTransform.position = airshipPosition;
+        airshipTransform.rotation = glm::radians(airshipRotation);
+        airshipTransform.dirty = true;
 
-        glUniform1i(windEffectLoc, 0);  
+        aimImpactValid = aimMode && predict_impact(package_drop_position(), PACKAGE_DROP_VELOCITY, aimImpact);
 
-        glUniform3fv(baseColorLoc, 1, glm::value_ptr(rock.baseColor));
+        //   ,     
+        int shadowStaticRedraws = shadowCascades.update(glm::vec3(airshipPosition.x, 0.0f, airshipPosition.z));
 
-        for (const auto& pos : rockPositions) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            render_object(rock, model);
+        frameDelta = deltaTime;
+        frameTime = (float)currentTime;
+        frameView = view;
+        viewProjection = projection * view;
+        {
+            Profiler::Scope scope(profiler, "frame graph");
+            frameGraph.run(jobs);
+        }
+        for (const auto& node : frameGraph.nodes) {
+            profiler.add_time(node->name, node->lastMs);
         }
 
-        glUniform1i(useTextureLoc, 1);
-        for (const auto& house : houses) {
-            GameObject* houseObj;
-            switch (house.houseType) {
-            case 0: houseObj = &house1; break;
-            case 1: houseObj = &house2; break;
-            case 2: houseObj = &house3; break;
-            default: houseObj = &house1;
+        size_t visibleInstances = 0;
+        {
+            Profiler::Scope scope(profiler, "gl submit");
+
+            //  :       
+            //   ,      
+            // (    )
+            glfwPollEvents();
+            framePacer.input_sampled();
+            steer_airship(window);
+            place_camera();
+            view = camera.GetView();
+            airshipTransform.position = airshipPosition;
+            airshipTransform.rotation = glm::radians(airshipRotation);
+            airshipTransform.dirty = true;
+            if (playerInstanceIndex >= 0) {
+                instanceLists[MESH_AIRSHIP][playerInstanceIndex].model = transform_matrix(airshipTransform);
             }
 
-            glm::vec3 color = houseObj->baseColor;
-            if (!house.hasPackage) {
-                color = glm::mix(color, glm::vec3(1.0f, 0.0f, 0.0f), 0.3f);
+            {
+                Profiler::Scope textureScope(profiler, "texture streaming");
+                request_texture_sizes(camera.position, projection, dynamicResolution.render_height());
+                textureStreamer.update();
             }
 
-            glUniform3fv(baseColorLoc, 1, glm::value_ptr(color));
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, house.position);
-            model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            render_object(*houseObj, model);
-        }
-
-        glUniform1i(useNormalMapLoc, 1);  
-        glUniform1i(useTextureLoc, 1);
-        glUniform3fv(baseColorLoc, 1, glm::value_ptr(airship.baseColor));
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, airshipPosition);
-        model = glm::rotate(model, glm::radians(airshipRotation), glm::vec3(0, 1, 0));
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        render_object(airship, model, true, true);  
-
-        glUniform1i(useNormalMapLoc, 0);
-        glUniform1i(useTextureLoc, 0);
-        glUniform3fv(baseColorLoc, 1, glm::value_ptr(packageObj.baseColor));
-
-        for (const auto& pkg : packages) {
-            if (pkg.active) {
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, pkg.position);
-                model = glm::rotate(model, pkg.rotation, glm::vec3(0, 1, 0));
-                model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-                render_object(packageObj, model, false);
+            dynamicResolution.begin_frame();
+
+            FrameData frameData;
+            frameData.view = view;
+            frameData.projection = projection;
+            frameData.lightDir = glm::vec4(lightDir, 0.0f);
+            frameData.params = glm::vec4((float)currentTime, 0.2f, 1.8f, 0.0f);
+            frameData.ambient = glm::vec4(0.3f, 0.3f, 0.27f, 0.0f);
+            frameData.clusterParams = glm::vec4(clusteredLights.nearPlane, clusteredLights.farPlane,
+                clusteredLights.slice_scale(), (float)ClusteredLights::SLICES);
+            frameData.screenParams = glm::vec4((float)dynamicResolution.render_width(), (float)dynamicResolution.render_height(),
+                (float)ClusteredLights::TILES_X, (float)ClusteredLights::TILES_Y);
+            for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+                frameData.lightMatrices[c] = shadowCascades.matrices[c];
             }
+            bool uploaded = upload_frame_data(frameData);
+
+            if (uploaded) {
+                Profiler::Scope shadowScope(profiler, "shadow pass");
+                glUseProgram(shadowProgram);
+                glEnable(GL_POLYGON_OFFSET_FILL);
+                glPolygonOffset(2.0f, 4.0f);
+
+                for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+                    glUniform1i(shadowCascadeLoc, c);
+                    if (shadowCascades.staticDirty[c]) {
+                        shadowCascades.begin_static(c);
+                        for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+                            render_instances(*meshes[mesh], shadowStatic[c][mesh].size(), shadowStaticOffsets[c][mesh]);
+                        }
+                    }
+                    shadowCascades.begin_dynamic(c);
+                    for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+                        render_instances(*meshes[mesh], shadowDynamic[c][mesh].size(), shadowDynamicOffsets[c][mesh]);
+                    }
+                }
+                shadowCascades.mark_cached();
+
+                glDisable(GL_POLYGON_OFFSET_FILL);
+                glUseProgram(shaderProgram);
+            }
+
+            glActiveTexture(GL_TEXTURE5);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, shadowCascades.depthTexture);
+            glActiveTexture(GL_TEXTURE0);
+
+            clusteredLights.upload();
+            clusteredLights.bind(2);
+
+            dynamicResolution.bind_scene();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            for (int mesh = 0; mesh < MESH_COUNT && uploaded; mesh++) {
+                glUniform1i(useNormalMapLoc, meshes[mesh]->normalMap != 0 ? 1 : 0);
+                render_instances(*meshes[mesh], instanceLists[mesh].size(), instanceOffsets[mesh]);
+                visibleInstances += instanceLists[mesh].size();
+            }
+            if (uploaded) snowfall.draw(camera.position);
+
+            dynamicResolution.upscale(upscaleProgram, uvScaleLoc);
+            //  GL_TIME_ELAPSED  :    
+            dynamicResolution.end_frame();
+
+            {
+                Profiler::Scope minimapScope(profiler, "minimap");
+                //     -   
+                if (deliveredPackages + fleetDeliveries != minimapDelivered) {
+                    minimapDelivered = deliveredPackages + fleetDeliveries;
+                    minimap.invalidate();
+                }
+                if (minimap.begin_frame()) {
+                    build_minimap_markers();
+                    minimap.render();
+                }
+                Minimap::Marker player = { glm::vec4(airshipPosition.x, airshipPosition.z, 5.0f, 1.0f),
+                    glm::vec4(1.0f, 0.85f, 0.1f, 1.0f) };
+                minimap.composite(upscaleProgram, uvScaleLoc, framebufferWidth, framebufferHeight, player);
+                minimap.end_frame();
+            }
+            glUseProgram(shaderProgram);
+            streamBuffer.end_frame();
         }
+        profiler.add_time("stream wait", streamBuffer.waitMs);
+        profiler.set_counter("stream stalls", streamBuffer.stalled ? 1.0 : 0.0);
+        profiler.add_time("gpu frame", dynamicResolution.gpuMs);
+        profiler.add_time("minimap gpu", minimap.gpuMs);
+        profiler.add_time("pacing wait", framePacer.waitMs);
+        profiler.add_time("input latency", framePacer.latencyMs);
+        profiler.set_counter("render scale %", dynamicResolution.scale * 100.0);
 
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
             std::cout << "OpenGL error: " << error << std::endl;
         }
 
+        frameCapture.capture(framebufferWidth, framebufferHeight);
+        if (frameCapture.active()) {
+            profiler.add_time("capture readback", frameCapture.readbackMs);
+            profiler.set_counter("capture frames", (double)frameCapture.capturedFrames);
+            profiler.set_counter("capture dropped", (double)frameCapture.droppedFrames);
+        }
+
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        framePacer.frame_submitted();
+
+        profiler.set_counter("transforms updated", (double)transformSystem.updatedLastFrame);
+        profiler.set_counter("instances visible", (double)visibleInstances);
+        profiler.set_counter("instances culled", (double)(world.count<Renderable>() + packages.size() - visibleInstances));
+        profiler.add_time("occlusion test", occlusionTestMs);
+        profiler.set_counter("occluders", (double)(occlusionEnabled ? occluders.size() : 0));
+        profiler.set_counter("occluder triangles", (double)(occlusionEnabled ? occlusionBuffer.trianglesDrawn : 0));
+        profiler.set_counter("instances occluded", (double)occludedCount.load());
+        profiler.set_counter("lights visible", (double)clusteredLights.visibleLights);
+        profiler.set_counter("light indices", (double)clusteredLights.indexCount);
+        size_t shadowDynamicCount = 0;
+        for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+            for (int mesh = 0; mesh < MESH_COUNT; mesh++) shadowDynamicCount += shadowDynamic[c][mesh].size();
+        }
+        profiler.set_counter("shadow static cascades", (double)shadowStaticRedraws);
+        profiler.set_counter("shadow dynamic casters", (double)shadowDynamicCount);
+        profiler.set_counter("minimap updates", (double)minimap.updatesLastFrame);
+        profiler.set_counter("snow flakes", (double)(snowfall.enabled ? snowfall.flakeCount : 0));
+        profiler.set_counter("packages in flight", (double)packages.size());
+        profiler.set_counter("fleet ships", (double)fleet.size());
+        profiler.set_counter("fleet delivering", (double)fleet.busy_ships());
+        profiler.set_counter("fleet avoidances", (double)fleet.avoidances);
+        profiler.set_counter("fleet deliveries", (double)fleetDeliveries);
+        profiler.set_counter("gpu memory MB", GpuMemory::mb(gpuMemory.totalBytes));
+        profiler.set_counter("texture resident MB", GpuMemory::mb(textureStreamer.residentBytes));
+        profiler.set_counter("texture host MB", GpuMemory::mb(textureStreamer.hostBytes));
+        profiler.set_counter("texture upload KB", textureStreamer.uploadedBytes / 1024.0);
+        profiler.set_counter("texture decodes", (double)textureStreamer.pendingDecodes);
+        profiler.set_counter("heap allocations", (double)(heap_allocation_count() - frameAllocations));
+        for (int i = 0; i < jobs.worker_count(); i++) {
+            profiler.set_worker(i, jobs.stats[i].busyNs / 1e6, jobs.stats[i].jobs, jobs.stats[i].steals);
+        }
+        jobs.reset_stats();
+        profiler.end_frame(deltaTime * 1000.0);
     }
 
+    frameCapture.stop();
+    jobs.stop();
+    streamBuffer.destroy();
+    clusteredLights.destroy();
+    textureStreamer.destroy();
+    shadowCascades.destroy();
+    snowfall.destroy();
+    minimap.destroy();
+    dynamicResolution.destroy();
+    framePacer.destroy();
     glfwTerminate();
     std::cout << "Program terminated successfully" << std::endl;
     return 0;
@@ -0,0 +1,198 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "shaders.h"
+
+// :    ( , ,  
+// )       updateInterval  
+//   invalidate() - ,    .
+//           
+// ,      .
+class Minimap {
+public:
+    struct Marker {
+        glm::vec4 placement;   // x, z, ,  (0 - , 1 - )
+        glm::vec4 color;
+    };
+
+    static const int SIZE = 256;
+    static const int QUERIES = 4;
+
+    int updateInterval = 15;
+    float worldHalfExtent = 200.0f;
+    float screenFraction = 0.3f;   //     
+    int margin = 16;
+
+    std::vector<Marker> markers;   //   render()
+    int updatesLastFrame = 0;
+    double gpuMs = 0.0;            //   ,   
+
+    bool create() {
+        program = CreateMinimapProgram();
+        if (program == 0) return false;
+        extentLocation = glGetUniformLocation(program, "mapExtent");
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SIZE, SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) std::cout << "Minimap framebuffer is incomplete" << std::endl;
+
+        //  -  ,    
+        glGenQueries(QUERIES, queries);
+        glGenVertexArrays(1, &emptyVao);
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &markerBuffer);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, markerBuffer);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Marker), (void*)offsetof(Marker, placement));
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Marker), (void*)offsetof(Marker, color));
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        dirty = true;
+        return complete;
+    }
+
+    void destroy() {
+        glDeleteProgram(program);
+        glDeleteTextures(1, &texture);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteVertexArrays(1, &emptyVao);
+        glDeleteBuffers(1, &markerBuffer);
+        glDeleteQueries(QUERIES, queries);
+    }
+
+    unsigned int texture_id() const { return texture; }
+
+    void invalidate() { dirty = true; }
+
+    //   ; true -   markers   render()
+    //  GPU - GL_TIME_ELAPSED  begin_frame()  end_frame(),  
+    // DynamicResolution;         .
+    bool begin_frame() {
+        read_timings();
+        measuring = !pending[current];
+        if (measuring) glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+
+        updatesLastFrame = 0;
+        framesSinceUpdate++;
+        return dirty || framesSinceUpdate >= updateInterval;
+    }
+
+    void end_frame() {
+        if (!measuring) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+        current = (current + 1) % QUERIES;
+    }
+
+    //    markers;  -   
+    void render() {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, SIZE, SIZE);
+        glDisable(GL_DEPTH_TEST);
+        // glClearBuffer    glClearColor 
+        const float background[4] = { 0.85f, 0.88f, 0.9f, 1.0f };
+        glClearBufferfv(GL_COLOR, 0, background);
+        draw_markers(markers.data(), markers.size());
+        glEnable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        dirty = false;
+        framesSinceUpdate = 0;
+        updatesLastFrame = 1;
+    }
+
+    //      ; program - CreateUpscaleProgram()
+    void composite(unsigned int upscaleProgram, int uvScaleLocation, int windowWidth, int windowHeight,
+        const Marker& player) {
+        int side = std::min((int)(windowHeight * screenFraction), windowWidth - 2 * margin);
+        if (side <= 0) return;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(windowWidth - side - margin, windowHeight - side - margin, side, side);
+        glDisable(GL_DEPTH_TEST);
+
+        glUseProgram(upscaleProgram);
+        glUniform2f(uvScaleLocation, 1.0f, 1.0f);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        draw_markers(&player, 1);
+
+        glEnable(GL_DEPTH_TEST);
+        glViewport(0, 0, windowWidth, windowHeight);
+    }
+
+private:
+    unsigned int program = 0;
+    unsigned int texture = 0;
+    unsigned int fbo = 0;
+    unsigned int vao = 0;
+    unsigned int emptyVao = 0;
+    unsigned int markerBuffer = 0;
+    int extentLocation = -1;
+    int framesSinceUpdate = 0;
+    bool dirty = true;
+
+    unsigned int queries[QUERIES] = {};
+    bool pending[QUERIES] = {};
+    int current = 0;
+    bool measuring = false;
+
+    void read_timings() {
+        for (int i = 0; i < QUERIES; i++) {
+            int index = (current + i) % QUERIES;
+            if (!pending[index]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &ns);
+            pending[index] = false;
+            gpuMs = ns / 1e6;
+        }
+    }
+
+    void draw_markers(const Marker* data, size_t count) {
+        if (count == 0) return;
+        glUseProgram(program);
+        glUniform1f(extentLocation, worldHalfExtent);
+        glBindBuffer(GL_ARRAY_BUFFER, markerBuffer);
+        //     :     
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(Marker), data, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+        glBindVertexArray(0);
+    }
+};
+
+#endif
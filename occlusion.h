@@ -0,0 +1,181 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "bvh.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SIMD 1
+#include <emmintrin.h>
+#endif
+
+//        
+// .  (       
+// )   4   ,  NDC- 
+// .  :
+//  ,         
+//  .
+class OcclusionBuffer {
+public:
+    static const int WIDTH = 256;   //  4
+    static const int HEIGHT = 128;
+
+    size_t trianglesDrawn = 0;
+
+    OcclusionBuffer() : depth((size_t)WIDTH * HEIGHT, 1.0f) {}
+
+    void begin(const glm::mat4& viewProjection) {
+        matrix = viewProjection;
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        trianglesDrawn = 0;
+    }
+
+    // box -    , model -   
+    void draw_box(const Aabb& box, const glm::mat4& model) {
+        glm::vec4 clip[8];
+        project_corners(box, matrix * model, clip);
+
+        //       
+        static const int quads[6][4] = {
+            {1, 3, 7, 5}, {0, 4, 6, 2}, {2, 6, 7, 3},
+            {0, 1, 5, 4}, {4, 5, 7, 6}, {0, 2, 3, 1}
+        };
+        for (const auto& q : quads) {
+            draw_triangle(clip[q[0]], clip[q[1]], clip[q[2]]);
+            draw_triangle(clip[q[0]], clip[q[2]], clip[q[3]]);
+        }
+    }
+
+    bool box_visible(const Aabb& box) const {
+        glm::vec4 clip[8];
+        project_corners(box, matrix, clip);
+
+        glm::vec2 ndcMin(1e30f), ndcMax(-1e30f);
+        float nearest = 1e30f;
+        for (const auto& c : clip) {
+            //    -  
+            if (c.w <= NEAR_W) return true;
+            glm::vec3 ndc = glm::vec3(c) / c.w;
+            ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+            ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+            nearest = std::min(nearest, ndc.z);
+        }
+        if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f) return true;
+
+        int minX = std::max(0, (int)((ndcMin.x * 0.5f + 0.5f) * WIDTH));
+        int maxX = std::min(WIDTH - 1, (int)((ndcMax.x * 0.5f + 0.5f) * WIDTH));
+        int minY = std::max(0, (int)((ndcMin.y * 0.5f + 0.5f) * HEIGHT));
+        int maxY = std::min(HEIGHT - 1, (int)((ndcMax.y * 0.5f + 0.5f) * HEIGHT));
+
+        //     4    
+        minX &= ~3;
+        for (int y = minY; y <= maxY; y++) {
+            const float* row = &depth[(size_t)y * WIDTH];
+#ifdef OCCLUSION_SIMD
+            __m128 boxDepth = _mm_set1_ps(nearest);
+            for (int x = minX; x <= maxX; x += 4) {
+                if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth))) return true;
+            }
+#else
+            for (int x = minX; x <= maxX; x++) {
+                if (row[x] >= nearest) return true;
+            }
+#endif
+        }
+        return false;
+    }
+
+private:
+    static constexpr float NEAR_W = 1e-3f;
+
+    std::vector<float> depth;
+    glm::mat4 matrix;
+
+    static void project_corners(const Aabb& box, const glm::mat4& m, glm::vec4* clip) {
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 p((i & 1) ? box.max.x : box.min.x,
+                        (i & 2) ? box.max.y : box.min.y,
+                        (i & 4) ? box.max.z : box.min.z);
+            clip[i] = m * glm::vec4(p, 1.0f);
+        }
+    }
+
+    void draw_triangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2) {
+        //     :    
+        if (c0.w <= NEAR_W || c1.w <= NEAR_W || c2.w <= NEAR_W) return;
+
+        glm::vec3 v[3] = { glm::vec3(c0) / c0.w, glm::vec3(c1) / c1.w, glm::vec3(c2) / c2.w };
+        for (auto& p : v) {
+            p.x = (p.x * 0.5f + 0.5f) * WIDTH;
+            p.y = (p.y * 0.5f + 0.5f) * HEIGHT;
+        }
+
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area <= 0.0f) return;  //  
+
+        int minX = std::max(0, (int)floorf(std::min(std::min(v[0].x, v[1].x), v[2].x)));
+        int maxX = std::min(WIDTH - 1, (int)ceilf(std::max(std::max(v[0].x, v[1].x), v[2].x)));
+        int minY = std::max(0, (int)floorf(std::min(std::min(v[0].y, v[1].y), v[2].y)));
+        int maxY = std::min(HEIGHT - 1, (int)ceilf(std::max(std::max(v[0].y, v[1].y), v[2].y)));
+        if (minX > maxX || minY > maxY) return;
+        trianglesDrawn++;
+
+        // и: e(x, y) = a * x + b * y + c >= 0 
+        float a[3], b[3], c[3];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec3& p = v[i];
+            const glm::vec3& q = v[(i + 1) % 3];
+            a[i] = p.y - q.y;
+            b[i] = q.x - p.x;
+            c[i] = p.x * q.y - p.y * q.x;
+        }
+
+        //   z = za * x + zb * y + zc
+        float za = ((v[1].z - v[0].z) * (v[2].y - v[0].y) - (v[2].z - v[0].z) * (v[1].y - v[0].y)) / area;
+        float zb = ((v[1].x - v[0].x) * (v[2].z - v[0].z) - (v[2].x - v[0].x) * (v[1].z - v[0].z)) / area;
+        float zc = v[0].z - za * v[0].x - zb * v[0].y;
+
+        minX &= ~3;
+        for (int y = minY; y <= maxY; y++) {
+            float py = y + 0.5f;
+            float* row = &depth[(size_t)y * WIDTH];
+#ifdef OCCLUSION_SIMD
+            __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 zero = _mm_setzero_ps();
+            __m128 e0Row = _mm_set1_ps(b[0] * py + c[0]);
+            __m128 e1Row = _mm_set1_ps(b[1] * py + c[1]);
+            __m128 e2Row = _mm_set1_ps(b[2] * py + c[2]);
+            __m128 zRow = _mm_set1_ps(zb * py + zc);
+
+            for (int x = minX; x <= maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), px), e0Row);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), px), e1Row);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), px), e2Row);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                    _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), zRow);
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (int x = minX; x <= maxX; x++) {
+                float px = x + 0.5f;
+                if (a[0] * px + b[0] * py + c[0] < 0.0f) continue;
+                if (a[1] * px + b[1] * py + c[1] < 0.0f) continue;
+                if (a[2] * px + b[2] * py + c[2] < 0.0f) continue;
+                row[x] = std::min(row[x], za * px + zb * py + zc);
+            }
+#endif
+        }
+    }
+};
+
+#endif
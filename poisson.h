@@ -0,0 +1,197 @@
+#ifndef POISSON_H
+#define POISSON_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "jobs.h"
+#include "rng.h"
+
+//    :
+// spacing   -      ,
+// footprint -        
+struct PlacementType {
+    float spacing;
+    float footprint;
+    int count;
+};
+
+//     (Bridson)     spacing/sqrt(2).
+//  [-halfExtent, halfExtent]^2   ,  
+//       2x2:     ,
+//   ,       .
+class PoissonPlacer {
+public:
+    PoissonPlacer(float halfExtent, uint64_t seed, JobSystem* jobs = nullptr)
+        : halfExtent(halfExtent), seed(seed), jobs(jobs) {}
+
+    //   type.count ,   footprint-   
+    std::vector<glm::vec2> place(const PlacementType& type) {
+        const int attempts = 30;
+        float cell = type.spacing / sqrtf(2.0f);
+        int cellsPerTile = std::max(2, (int)ceilf(4.0f * type.spacing / cell));
+        float tileSize = cell * cellsPerTile;
+        int tiles = std::max(1, (int)ceilf(2.0f * halfExtent / tileSize));
+        int gridSize = tiles * cellsPerTile;
+
+        std::vector<glm::vec2> grid((size_t)gridSize * gridSize);
+        std::vector<uint8_t> occupied((size_t)gridSize * gridSize, 0);
+        build_exclusion_grid(type.footprint);
+
+        uint64_t typeSeed = mix_seed(seed, typeIndex++);
+        const float spacing2 = type.spacing * type.spacing;
+
+        auto fill_tile = [&](int tx, int tz) {
+            Rng rng(mix_seed(typeSeed, (uint64_t)tz * tiles + tx));
+            glm::vec2 tileMin(-halfExtent + tx * tileSize, -halfExtent + tz * tileSize);
+            glm::vec2 tileMax = glm::min(tileMin + glm::vec2(tileSize), glm::vec2(halfExtent));
+
+            auto try_insert = [&](const glm::vec2& p) {
+                if (p.x < tileMin.x || p.y < tileMin.y || p.x >= tileMax.x || p.y >= tileMax.y) return false;
+                int cx = std::min(gridSize - 1, (int)((p.x + halfExtent) / cell));
+                int cz = std::min(gridSize - 1, (int)((p.y + halfExtent) / cell));
+
+                for (int z = std::max(0, cz - 2); z <= std::min(gridSize - 1, cz + 2); z++) {
+                    for (int x = std::max(0, cx - 2); x <= std::min(gridSize - 1, cx + 2); x++) {
+                        size_t idx = (size_t)z * gridSize + x;
+                        if (!occupied[idx]) continue;
+                        glm::vec2 d = grid[idx] - p;
+                        if (glm::dot(d, d) < spacing2) return false;
+                    }
+                }
+                if (excluded(p, type.footprint)) return false;
+
+                size_t idx = (size_t)cz * gridSize + cx;
+                grid[idx] = p;
+                occupied[idx] = 1;
+                return true;
+            };
+
+            std::vector<glm::vec2> active;
+            for (int i = 0; i < attempts && active.empty(); i++) {
+                glm::vec2 p(rng.range(tileMin.x, tileMax.x), rng.range(tileMin.y, tileMax.y));
+                if (try_insert(p)) active.push_back(p);
+            }
+
+            while (!active.empty()) {
+                size_t pick = rng.next_u32() % active.size();
+                glm::vec2 center = active[pick];
+                bool found = false;
+
+                for (int i = 0; i < attempts; i++) {
+                    float angle = rng.next_float() * 6.2831853f;
+                    float dist = type.spacing * (1.0f + rng.next_float());
+                    glm::vec2 p = center + glm::vec2(cosf(angle), sinf(angle)) * dist;
+                    if (try_insert(p)) {
+                        active.push_back(p);
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found) {
+                    active[pick] = active.back();
+                    active.pop_back();
+                }
+            }
+        };
+
+        for (int phase = 0; phase < 4; phase++) {
+            int px = phase & 1;
+            int pz = phase >> 1;
+            int perRow = (tiles - px + 1) / 2;
+            int rows = (tiles - pz + 1) / 2;
+            uint32_t phaseTiles = (uint32_t)std::max(0, perRow * rows);
+
+            auto run = [&](uint32_t begin, uint32_t end) {
+                for (uint32_t t = begin; t < end; t++) {
+                    fill_tile(px + 2 * (int)(t % perRow), pz + 2 * (int)(t / perRow));
+                }
+            };
+            if (jobs) jobs->parallel_for(phaseTiles, 1, run);
+            else run(0, phaseTiles);
+        }
+
+        std::vector<glm::vec2> result;
+        for (size_t i = 0; i < occupied.size(); i++) {
+            if (occupied[i]) result.push_back(grid[i]);
+        }
+
+        //  ,    
+        Rng shuffleRng(mix_seed(typeSeed, 0xFFFFFFFFull));
+        for (size_t i = result.size(); i > 1; i--) {
+            std::swap(result[i - 1], result[shuffleRng.next_u32() % i]);
+        }
+        if ((int)result.size() > type.count) result.resize(type.count);
+
+        for (const auto& p : result) {
+            placed.push_back(p);
+            placedFootprint.push_back(type.footprint);
+            maxFootprint = std::max(maxFootprint, type.footprint);
+        }
+        return result;
+    }
+
+private:
+    float halfExtent;
+    uint64_t seed;
+    JobSystem* jobs;
+    uint64_t typeIndex = 0;
+
+    std::vector<glm::vec2> placed;
+    std::vector<float> placedFootprint;
+    float maxFootprint = 0.0f;
+
+    //     (CSR):  >=   
+    float exclusionCell = 1.0f;
+    int exclusionSize = 0;
+    std::vector<uint32_t> exclusionStart;
+    std::vector<uint32_t> exclusionItems;
+
+    void build_exclusion_grid(float footprint) {
+        exclusionSize = 0;
+        if (placed.empty()) return;
+
+        exclusionCell = std::max(1.0f, footprint + maxFootprint);
+        exclusionSize = std::max(1, (int)ceilf(2.0f * halfExtent / exclusionCell));
+        size_t cells = (size_t)exclusionSize * exclusionSize;
+
+        exclusionStart.assign(cells + 1, 0);
+        for (const auto& p : placed) exclusionStart[exclusion_cell(p) + 1]++;
+        for (size_t i = 0; i < cells; i++) exclusionStart[i + 1] += exclusionStart[i];
+
+        exclusionItems.resize(placed.size());
+        std::vector<uint32_t> fill(exclusionStart.begin(), exclusionStart.end() - 1);
+        for (uint32_t i = 0; i < placed.size(); i++) {
+            exclusionItems[fill[exclusion_cell(placed[i])]++] = i;
+        }
+    }
+
+    size_t exclusion_cell(const glm::vec2& p) const {
+        int x = std::min(exclusionSize - 1, std::max(0, (int)((p.x + halfExtent) / exclusionCell)));
+        int z = std::min(exclusionSize - 1, std::max(0, (int)((p.y + halfExtent) / exclusionCell)));
+        return (size_t)z * exclusionSize + x;
+    }
+
+    bool excluded(const glm::vec2& p, float footprint) const {
+        if (exclusionSize == 0) return false;
+
+        int cx = std::min(exclusionSize - 1, std::max(0, (int)((p.x + halfExtent) / exclusionCell)));
+        int cz = std::min(exclusionSize - 1, std::max(0, (int)((p.y + halfExtent) / exclusionCell)));
+        for (int z = std::max(0, cz - 1); z <= std::min(exclusionSize - 1, cz + 1); z++) {
+            for (int x = std::max(0, cx - 1); x <= std::min(exclusionSize - 1, cx + 1); x++) {
+                size_t c = (size_t)z * exclusionSize + x;
+                for (uint32_t k = exclusionStart[c]; k < exclusionStart[c + 1]; k++) {
+                    uint32_t i = exclusionItems[k];
+                    if (glm::distance(placed[i], p) < footprint + placedFootprint[i]) return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstdint>
+#include <vector>
+
+//    :  +     
+struct PoolHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool valid() const { return index != 0xFFFFFFFFu; }
+};
+
+const PoolHandle INVALID_POOL_HANDLE = { 0xFFFFFFFFu, 0 };
+
+//       (  ..).
+//     ;   , 
+//   get()   destroy().   
+//     .
+template <typename T>
+class Pool {
+public:
+    explicit Pool(uint32_t capacity)
+        : slots(capacity), generations(capacity, 0), livePosition(capacity, 0) {
+        freeList.reserve(capacity);
+        live.reserve(capacity);
+        for (uint32_t i = capacity; i-- > 0;) freeList.push_back(i);
+    }
+
+    uint32_t capacity() const { return (uint32_t)slots.size(); }
+    uint32_t size() const { return (uint32_t)live.size(); }
+    bool full() const { return freeList.empty(); }
+
+    //  INVALID_POOL_HANDLE,   
+    PoolHandle create(const T& value) {
+        if (freeList.empty()) return INVALID_POOL_HANDLE;
+        uint32_t index = freeList.back();
+        freeList.pop_back();
+
+        slots[index] = value;
+        livePosition[index] = (uint32_t)live.size();
+        live.push_back(index);
+        return { index, generations[index] };
+    }
+
+    bool alive(PoolHandle h) const {
+        return h.index < slots.size() && generations[h.index] == h.generation &&
+            livePosition[h.index] < live.size() && live[livePosition[h.index]] == h.index;
+    }
+
+    T* get(PoolHandle h) { return alive(h) ? &slots[h.index] : nullptr; }
+
+    void destroy(PoolHandle h) {
+        if (!alive(h)) return;
+
+        uint32_t position = livePosition[h.index];
+        uint32_t moved = live.back();
+        live[position] = moved;
+        livePosition[moved] = position;
+        live.pop_back();
+
+        generations[h.index]++;
+        freeList.push_back(h.index);
+    }
+
+    void clear() {
+        while (!live.empty()) destroy(handle_at(size() - 1));
+    }
+
+    //   : i  [0, size())
+    T& at(uint32_t i) { return slots[live[i]]; }
+    PoolHandle handle_at(uint32_t i) const { return { live[i], generations[live[i]] }; }
+
+private:
+    std::vector<T> slots;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeList;
+    std::vector<uint32_t> live;
+    std::vector<uint32_t> livePosition;
+};
+
+#endif
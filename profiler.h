@@ -0,0 +1,127 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+//   :   (), 
+//   .   reportInterval   .
+class Profiler {
+public:
+    static const int MAX_ENTRIES = 48;
+
+    struct Entry {
+        const char* name;
+        double frameValue;
+        double total;
+        double peak;
+    };
+
+    double reportInterval = 2.0;
+    bool enabled = true;
+
+    // RAII- 
+    class Scope {
+    public:
+        Scope(Profiler& profiler, const char* name)
+            : profiler(profiler), name(name), start(std::chrono::steady_clock::now()) {}
+        ~Scope() {
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            profiler.add_time(name, ms);
+        }
+    private:
+        Profiler& profiler;
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void add_time(const char* name, double ms) { find(sections, sectionCount, name).frameValue += ms; }
+    void set_counter(const char* name, double value) { find(counters, counterCount, name).frameValue = value; }
+
+    void set_worker(int index, double busyMs, unsigned jobs, unsigned steals) {
+        if (index >= MAX_ENTRIES) return;
+        if (index >= workerCount) workerCount = index + 1;
+        workers[index].busyMs += busyMs;
+        workers[index].jobs += jobs;
+        workers[index].steals += steals;
+    }
+
+    void end_frame(double frameMs) {
+        frames++;
+        frameTotal += frameMs;
+        accumulate(sections, sectionCount);
+        accumulate(counters, counterCount);
+
+        if (frameTotal >= reportInterval * 1000.0) {
+            if (enabled) report();
+            reset();
+        }
+    }
+
+    void report() const {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "--- profiler: " << frames << " frames, avg "
+            << frameTotal / frames << " ms ---" << std::endl;
+        for (int i = 0; i < sectionCount; i++) {
+            std::cout << "  " << std::setw(22) << std::left << sections[i].name << std::right
+                << sections[i].total / frames << " ms (peak " << sections[i].peak << ")" << std::endl;
+        }
+        for (int i = 0; i < counterCount; i++) {
+            std::cout << "  " << std::setw(22) << std::left << counters[i].name << std::right
+                << counters[i].total / frames << " (peak " << counters[i].peak << ")" << std::endl;
+        }
+        for (int i = 0; i < workerCount; i++) {
+            std::cout << "  worker " << std::setw(2) << i << "  busy "
+                << 100.0 * workers[i].busyMs / frameTotal << "%, jobs/frame "
+                << (double)workers[i].jobs / frames << ", steals/frame "
+                << (double)workers[i].steals / frames << std::endl;
+        }
+        std::cout << std::defaultfloat;
+    }
+
+private:
+    struct WorkerEntry {
+        double busyMs;
+        unsigned long long jobs;
+        unsigned long long steals;
+    };
+
+    Entry sections[MAX_ENTRIES] = {};
+    Entry counters[MAX_ENTRIES] = {};
+    WorkerEntry workers[MAX_ENTRIES] = {};
+    int sectionCount = 0;
+    int counterCount = 0;
+    int workerCount = 0;
+    int frames = 0;
+    double frameTotal = 0.0;
+
+    Entry& find(Entry* entries, int& count, const char* name) {
+        for (int i = 0; i < count; i++) {
+            if (entries[i].name == name || strcmp(entries[i].name, name) == 0) return entries[i];
+        }
+        if (count == MAX_ENTRIES) return entries[MAX_ENTRIES - 1];
+        entries[count] = { name, 0.0, 0.0, 0.0 };
+        return entries[count++];
+    }
+
+    static void accumulate(Entry* entries, int count) {
+        for (int i = 0; i < count; i++) {
+            entries[i].total += entries[i].frameValue;
+            if (entries[i].frameValue > entries[i].peak) entries[i].peak = entries[i].frameValue;
+            entries[i].frameValue = 0.0;
+        }
+    }
+
+    void reset() {
+        for (int i = 0; i < sectionCount; i++) sections[i].total = sections[i].peak = 0.0;
+        for (int i = 0; i < counterCount; i++) counters[i].total = counters[i].peak = 0.0;
+        for (int i = 0; i < workerCount; i++) workers[i] = { 0.0, 0, 0 };
+        frames = 0;
+        frameTotal = 0.0;
+    }
+};
+
+#endif
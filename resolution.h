@@ -0,0 +1,164 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+//  :      
+// ,      scale x scale.  GPU  
+// GL_TIME_ELAPSED  ,     
+//  ;    targetMs.  
+//       .
+class DynamicResolution {
+public:
+    static const int QUERIES = 4;
+
+    float targetMs = 15.0f;   //    16.7   vsync 60 
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float step = 0.05f;       //   ,  
+
+    float scale = 1.0f;
+    double gpuMs = 0.0;       //    
+    int windowWidth = 0;
+    int windowHeight = 0;
+
+    bool create(int width, int height) {
+        glGenQueries(QUERIES, queries);
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(1, &colorTexture);
+        glGenRenderbuffers(1, &depthBuffer);
+        glGenVertexArrays(1, &emptyVao);
+        return resize(width, height);
+    }
+
+    void destroy() {
+        glDeleteQueries(QUERIES, queries);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &colorTexture);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        glDeleteVertexArrays(1, &emptyVao);
+    }
+
+    //     ,      
+    bool resize(int width, int height) {
+        if (width <= 0 || height <= 0) return false;
+        windowWidth = width;
+        windowHeight = height;
+
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (!complete) std::cout << "Scene framebuffer is incomplete" << std::endl;
+        return complete;
+    }
+
+    int render_width() const { return std::max(1, (int)(windowWidth * scale)); }
+    int render_height() const { return std::max(1, (int)(windowHeight * scale)); }
+
+    //  :     ,   
+    void begin_frame() {
+        read_timings();
+
+        if (pending[current]) {
+            //      -    
+            measuring = false;
+        }
+        else {
+            glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+            measuring = true;
+        }
+    }
+
+    void bind_scene() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, render_width(), render_height());
+    }
+
+    //     ; program - CreateUpscaleProgram()
+    void upscale(unsigned int program, int uvScaleLocation) const {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, windowWidth, windowHeight);
+        glDisable(GL_DEPTH_TEST);
+
+        glUseProgram(program);
+        glUniform2f(uvScaleLocation, (float)render_width() / windowWidth, (float)render_height() / windowHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glBindVertexArray(emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void end_frame() {
+        if (!measuring) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+        current = (current + 1) % QUERIES;
+    }
+
+private:
+    unsigned int queries[QUERIES] = {};
+    bool pending[QUERIES] = {};
+    int current = 0;
+    bool measuring = false;
+
+    unsigned int fbo = 0;
+    unsigned int colorTexture = 0;
+    unsigned int depthBuffer = 0;
+    unsigned int emptyVao = 0;
+
+    void read_timings() {
+        //    - ,    
+        for (int i = 0; i < QUERIES; i++) {
+            int index = (current + i) % QUERIES;
+            if (!pending[index]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &ns);
+            pending[index] = false;
+            gpuMs = ns / 1e6;
+            adjust();
+        }
+    }
+
+    //  ~  , .. scale^2;  
+    //       -
+    void adjust() {
+        if (gpuMs <= 0.0) return;
+        double ratio = targetMs / gpuMs;
+        if (ratio > 0.9 && ratio < 1.15) return;
+
+        float wanted = scale * (float)std::sqrt(ratio);
+        float next = wanted < scale ? scale - step : scale + step;
+        //   -    
+        if (wanted < scale - step) next = std::floor(wanted / step) * step;
+        scale = std::min(maxScale, std::max(minScale, next));
+    }
+};
+
+#endif
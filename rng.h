@@ -0,0 +1,51 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// PCG32:   ,  
+//    (   std::*_distribution)
+struct Rng {
+    uint64_t state;
+    uint64_t inc;
+
+    explicit Rng(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL) {
+        state = 0;
+        inc = (stream << 1u) | 1u;
+        next_u32();
+        state += seed;
+        next_u32();
+    }
+
+    uint32_t next_u32() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // [0, 1)
+    float next_float() {
+        return (next_u32() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float range(float lo, float hi) {
+        return lo + (hi - lo) * next_float();
+    }
+
+    // [lo, hi]
+    int range_int(int lo, int hi) {
+        return lo + (int)(next_u32() % (uint32_t)(hi - lo + 1));
+    }
+};
+
+//       (splitmix64)
+inline uint64_t mix_seed(uint64_t a, uint64_t b) {
+    uint64_t z = a + 0x9e3779b97f4a7c15ULL * (b + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+#endif
@@ -10,24 +10,44 @@ layout(location = 1) in vec2 texCoords;
 layout(location = 2) in vec3 normal;
 layout(location = 3) in vec3 tangent;
 layout(location = 4) in float type;
+layout(location = 5) in float handedness;
+layout(location = 6) in mat4 instanceModel;
+layout(location = 10) in vec4 instanceColor;
+layout(location = 11) in vec4 instanceParams;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform float time;
-uniform bool windEffect;
-uniform float windStrength;
-uniform float windFrequency;
-uniform float treeHeight;
-uniform float windOffset;
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightDirection;
+    vec4 frameParams;   // ,  ,  
+    vec4 ambientColor;
+    vec4 clusterParams; //    ,  ,  
+    vec4 screenParams;  // , ,   x   y
+    mat4 lightMatrices[3];
+};
 
 out vec2 TexCoords;
+uniform int shadowCascade; // >= 0    
+
 out vec3 FragPos;
+out vec3 ViewPos;
 out vec3 Normal;
 out vec3 Tangent;
+out float Handedness;
 out float Type;
+flat out vec3 BaseColor;
+flat out int UseTexture;
 
 void main() {
+    float time = frameParams.x;
+    float windStrength = frameParams.y;
+    float windFrequency = frameParams.z;
+
+    mat4 model = instanceModel;
+    float treeHeight = instanceParams.x;
+    float windOffset = instanceParams.y;
+    bool windEffect = instanceParams.z > 0.5;
+
     vec3 pos = position;
     
     if (windEffect && type > 1.5) { 
@@ -59,12 +79,20 @@ void main() {
     }
     
     FragPos = vec3(model * vec4(pos, 1.0));
+    ViewPos = vec3(view * vec4(FragPos, 1.0));
     TexCoords = texCoords;
     Normal = mat3(transpose(inverse(model))) * normal;
-    Tangent = tangent;
+    Tangent = mat3(model) * tangent;
+    Handedness = handedness;
     Type = type;
+    BaseColor = instanceColor.rgb;
+    UseTexture = instanceColor.a > 0.5 ? 1 : 0;
     
-    gl_Position = projection * view * model * vec4(pos, 1.0);
+    if (shadowCascade >= 0) {
+        gl_Position = lightMatrices[shadowCascade] * vec4(FragPos, 1.0);
+    } else {
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
 })";
 
 const char* fs_source = R"(#version 330 core
@@ -72,17 +100,32 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 in vec3 FragPos;
+in vec3 ViewPos;
 in vec3 Normal;
 in vec3 Tangent;
+in float Handedness;
 in float Type;
+flat in vec3 BaseColor;
+flat in int UseTexture;
 
 uniform sampler2D texture0;
 uniform sampler2D texture1;
-uniform vec3 lightDir;
-uniform vec3 baseColor;
-uniform bool useTexture;
 uniform bool useNormalMap;
-uniform float time;
+uniform samplerBuffer lightData;      //  + , 
+uniform usamplerBuffer clusterData;   //     
+uniform usamplerBuffer lightIndices;
+uniform sampler2DArrayShadow shadowMap;
+
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightDirection;
+    vec4 frameParams;   // ,  ,  
+    vec4 ambientColor;
+    vec4 clusterParams; //    ,  ,  
+    vec4 screenParams;  // , ,   x   y
+    mat4 lightMatrices[3];
+};
 
 vec3 calculateNormal() {
     vec3 normalMap = texture(texture1, TexCoords).rgb;
@@ -93,22 +136,68 @@ vec3 calculateNormal() {
     vec3 T = normalize(Tangent);
     
     T = normalize(T - dot(T, N) * N);
-    vec3 B = cross(N, T);
+    vec3 B = cross(N, T) * Handedness;
     
     mat3 TBN = mat3(T, B, N);
     
     return normalize(TBN * normalMap);
 }
 
+//  ,    , 4    
+float shadowFactor() {
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    for (int i = 0; i < 3; i++) {
+        vec3 p = (lightMatrices[i] * vec4(FragPos, 1.0)).xyz * 0.5 + 0.5;
+        if (any(lessThan(p.xy, vec2(0.01))) || any(greaterThan(p.xy, vec2(0.99))) || p.z > 1.0) continue;
+
+        float reference = p.z - 0.0005 * float(i + 1);
+        float lit = 0.0;
+        for (int x = -1; x <= 1; x += 2) {
+            for (int y = -1; y <= 1; y += 2) {
+                lit += texture(shadowMap, vec4(p.xy + vec2(x, y) * 0.5 * texel, float(i), reference));
+            }
+        }
+        return lit * 0.25;
+    }
+    return 1.0;
+}
+
+//     
+vec3 pointLighting(vec3 norm) {
+    float depth = -ViewPos.z;
+    if (depth < clusterParams.x || depth > clusterParams.y) return vec3(0.0);
+
+    ivec2 tiles = ivec2(screenParams.zw);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / screenParams.xy * screenParams.zw), ivec2(0), tiles - 1);
+    int slice = clamp(int(log(depth / clusterParams.x) * clusterParams.z), 0, int(clusterParams.w) - 1);
+    int cluster = (slice * tiles.y + tile.y) * tiles.x + tile.x;
+
+    uvec2 range = texelFetch(clusterData, cluster).xy;
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(lightIndices, int(range.x + i)).r);
+        vec4 positionRadius = texelFetch(lightData, light * 2);
+        vec3 color = texelFetch(lightData, light * 2 + 1).rgb;
+
+        vec3 toLight = positionRadius.xyz - FragPos;
+        float dist2 = dot(toLight, toLight);
+        float falloff = clamp(1.0 - dist2 / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+        falloff *= falloff;
+        result += color * max(dot(norm, toLight * inversesqrt(max(dist2, 1e-4))), 0.0) * falloff;
+    }
+    return result;
+}
+
 void main() {
-    vec3 color = baseColor;
+    vec3 lightDir = lightDirection.xyz;
+    vec3 color = BaseColor;
     
-    if (useTexture) {
+    if (UseTexture != 0) {
         color = texture(texture0, TexCoords).rgb;
     }
     
     if (Type > 0.5) {
-        color = baseColor;
+        color = BaseColor;
     }
     
     vec3 norm;
@@ -119,7 +208,7 @@ void main() {
     }
     
     vec3 lightColor = vec3(1.0, 1.0, 0.9);
-    vec3 ambient = vec3(0.3) * lightColor;
+    vec3 ambient = ambientColor.rgb;
     
     float diff = max(dot(norm, -lightDir), 0.0);
     vec3 diffuse = diff * lightColor;
@@ -129,14 +218,165 @@ void main() {
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
     vec3 specular = spec * vec3(0.3, 0.3, 0.3);
     
-    vec3 result = (ambient + diffuse + specular) * color;
+    float shadow = shadowFactor();
+    vec3 result = (ambient + (diffuse + specular) * shadow + pointLighting(norm)) * color;
     
     FragColor = vec4(result, 1.0);
 })";
 
-inline unsigned int CreateShaderProgram() {
+//  :     ( ),  
+const char* shadow_fs_source = R"(#version 330 core
+void main() {
+})";
+
+//     :     
+const char* upscale_vs_source = R"(#version 330 core
+out vec2 TexCoord;
+uniform vec2 uvScale;  //  ,  
+
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = corner * uvScale;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+const char* upscale_fs_source = R"(#version 330 core
+in vec2 TexCoord;
+out vec4 FragColor;
+uniform sampler2D sceneColor;
+uniform vec2 uvScale;
+
+void main() {
+    //      :  
+    //       
+    vec2 uvMax = uvScale - 0.5 / vec2(textureSize(sceneColor, 0));
+    FragColor = vec4(texture(sceneColor, min(TexCoord, uvMax)).rgb, 1.0);
+})";
+
+// :   ,  -   4 . 
+//      ,    :
+//     ,   ,   
+// ( ,    ),    
+//   .
+const char* snow_vs_source = R"(#version 330 core
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightDirection;
+    vec4 frameParams;   // ,  ,  
+    vec4 ambientColor;
+    vec4 clusterParams;
+    vec4 screenParams;
+    mat4 lightMatrices[3];
+};
+
+uniform vec3 cameraPosition;
+uniform vec4 snowParams;   //  ,  ,  ,     
+
+out vec2 Corner;
+
+// PCG-:      
+uint hash(uint x) {
+    x = x * 747796405u + 2891336453u;
+    x = ((x >> ((x >> 28u) + 4u)) ^ x) * 277803737u;
+    return (x >> 22u) ^ x;
+}
+
+float random(inout uint seed) {
+    seed = hash(seed);
+    return float(seed) * (1.0 / 4294967296.0);
+}
+
+void main() {
+    float time = frameParams.x;
+    float windStrength = frameParams.y;
+    float windFrequency = frameParams.z;
+    float volume = snowParams.x;
+
+    uint seed = uint(gl_InstanceID) * 3u + 1u;
+    vec3 base = vec3(random(seed), random(seed), random(seed)) * volume;
+    float speed = snowParams.z * mix(0.6, 1.4, random(seed));
+    float phase = random(seed) * 6.2831853;
+    float size = snowParams.y * mix(0.5, 1.5, random(seed));
+
+    //   1 + 0.5 cos(wt),  -  
+    float gust = windFrequency * 0.2;
+    float drift = windStrength * snowParams.w * (time + 0.5 * sin(gust * time) / max(gust, 1e-3));
+    vec3 offset = vec3(drift, -speed * time, drift * 0.4);
+    //   
+    offset.xz += vec2(sin(time * windFrequency + phase), cos(time * windFrequency * 0.8 + phase)) * 0.6;
+
+    //     : ,   ,   
+    vec3 local = mod(base + offset - cameraPosition + volume * 0.5, volume) - volume * 0.5;
+    vec3 world = cameraPosition + local;
+
+    //      -      
+    vec3 edge = 1.0 - abs(local) / (volume * 0.5);
+    size *= smoothstep(0.0, 0.15, min(edge.x, min(edge.y, edge.z)));
+    if (world.y < 0.0) size = 0.0;
+
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    world += (right * Corner.x + up * Corner.y) * size;
+
+    gl_Position = projection * view * vec4(world, 1.0);
+})";
+
+const char* snow_fs_source = R"(#version 330 core
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightDirection;
+    vec4 frameParams;
+    vec4 ambientColor;
+    vec4 clusterParams;
+    vec4 screenParams;
+    mat4 lightMatrices[3];
+};
+
+in vec2 Corner;
+out vec4 FragColor;
+
+void main() {
+    if (dot(Corner, Corner) > 1.0) discard;
+    FragColor = vec4(vec3(0.95, 0.97, 1.0) * (ambientColor.rgb + vec3(0.7)), 1.0);
+})";
+
+// :  -    4 ,  
+//   (x , -z )
+const char* minimap_vs_source = R"(#version 330 core
+layout(location = 0) in vec4 placement;   // x, z, ,  (0 - , 1 - )
+layout(location = 1) in vec4 color;
+
+uniform float mapExtent;   //     
+
+out vec2 Corner;
+flat out vec4 MarkerColor;
+flat out float Shape;
+
+void main() {
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    MarkerColor = color;
+    Shape = placement.w;
+    vec2 world = placement.xy + Corner * placement.z;
+    gl_Position = vec4(world.x / mapExtent, -world.y / mapExtent, 0.0, 1.0);
+})";
+
+const char* minimap_fs_source = R"(#version 330 core
+in vec2 Corner;
+flat in vec4 MarkerColor;
+flat in float Shape;
+out vec4 FragColor;
+
+void main() {
+    if (Shape > 0.5 && dot(Corner, Corner) > 1.0) discard;
+    FragColor = MarkerColor;
+})";
+
+inline unsigned int CompileProgram(const char* vertexSource, const char* fragmentSource) {
     unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vs_source, NULL);
+    glShaderSource(vertexShader, 1, &vertexSource, NULL);
     glCompileShader(vertexShader);
 
     int success;
@@ -148,7 +388,7 @@ inline unsigned int CreateShaderProgram() {
     }
 
     unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fs_source, NULL);
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
     glCompileShader(fragmentShader);
 
     glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
@@ -174,4 +414,24 @@ inline unsigned int CreateShaderProgram() {
     return shaderProgram;
 }
 
+inline unsigned int CreateShaderProgram() {
+    return CompileProgram(vs_source, fs_source);
+}
+
+inline unsigned int CreateShadowProgram() {
+    return CompileProgram(vs_source, shadow_fs_source);
+}
+
+inline unsigned int CreateUpscaleProgram() {
+    return CompileProgram(upscale_vs_source, upscale_fs_source);
+}
+
+inline unsigned int CreateSnowProgram() {
+    return CompileProgram(snow_vs_source, snow_fs_source);
+}
+
+inline unsigned int CreateMinimapProgram() {
+    return CompileProgram(minimap_vs_source, minimap_fs_source);
+}
+
 #endif
\ No newline at end of file
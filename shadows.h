@@ -0,0 +1,149 @@
+#ifndef SHADOWS_H
+#define SHADOWS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <iostream>
+
+//      .  - 
+//      .  (, ) 
+//   -       
+//  rebuildFraction * ;      
+//       .
+class ShadowCascades {
+public:
+    static const int CASCADES = 3;
+    static const int SIZE = 1024;
+
+    float radii[CASCADES] = { 60.0f, 200.0f, 600.0f };
+    float rebuildFraction = 0.25f;
+    float depthRange = 1000.0f;   //       
+
+    glm::mat4 matrices[CASCADES];
+    bool staticDirty[CASCADES] = {};
+    unsigned int depthTexture = 0;   // sampler2DArrayShadow
+
+    bool create(const glm::vec3& lightDirection) {
+        glm::vec3 up = fabsf(lightDirection.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+        lightView = glm::lookAt(-lightDirection, glm::vec3(0.0f), up);
+
+        depthTexture = create_array(true);
+        staticTexture = create_array(false);
+        glGenFramebuffers(1, &liveFbo);
+        glGenFramebuffers(1, &staticFbo);
+
+        bool complete = true;
+        unsigned int fbos[2] = { liveFbo, staticFbo };
+        unsigned int textures[2] = { depthTexture, staticTexture };
+        for (int i = 0; i < 2; i++) {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textures[i], 0, 0);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+            complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (!complete) std::cout << "Shadow framebuffer is incomplete" << std::endl;
+        return complete;
+    }
+
+    void destroy() {
+        glDeleteFramebuffers(1, &liveFbo);
+        glDeleteFramebuffers(1, &staticFbo);
+        glDeleteTextures(1, &depthTexture);
+        glDeleteTextures(1, &staticTexture);
+    }
+
+    //    focus.   ,
+    //       .
+    int update(const glm::vec3& focus) {
+        int dirty = 0;
+        for (int c = 0; c < CASCADES; c++) {
+            if (!cached[c] || glm::distance(focus, centers[c]) > radii[c] * rebuildFraction) {
+                centers[c] = focus;
+                matrices[c] = cascade_matrix(focus, radii[c]);
+                staticDirty[c] = true;
+            }
+            if (staticDirty[c]) dirty++;
+        }
+        return dirty;
+    }
+
+    //  :      
+    void begin_static(int cascade) {
+        glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, cascade);
+        glViewport(0, 0, SIZE, SIZE);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    //     ,    
+    void begin_dynamic(int cascade) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFbo);
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, cascade);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, liveFbo);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, cascade);
+        glBlitFramebuffer(0, 0, SIZE, SIZE, 0, 0, SIZE, SIZE, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, liveFbo);
+        glViewport(0, 0, SIZE, SIZE);
+    }
+
+    //    (  )
+    void invalidate() {
+        for (int c = 0; c < CASCADES; c++) cached[c] = false;
+    }
+
+    //     
+    void mark_cached() {
+        for (int c = 0; c < CASCADES; c++) {
+            cached[c] = true;
+            staticDirty[c] = false;
+        }
+    }
+
+private:
+    glm::mat4 lightView;
+    glm::vec3 centers[CASCADES];
+    bool cached[CASCADES] = {};
+    unsigned int staticTexture = 0;
+    unsigned int liveFbo = 0;
+    unsigned int staticFbo = 0;
+
+    unsigned int create_array(bool compare) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, SIZE, SIZE, CASCADES, 0,
+            GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (compare) {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return texture;
+    }
+
+    //     ,    
+    //   
+    glm::mat4 cascade_matrix(const glm::vec3& center, float radius) const {
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        float texel = 2.0f * radius / SIZE;
+        lightCenter.x = floorf(lightCenter.x / texel) * texel;
+        lightCenter.y = floorf(lightCenter.y / texel) * texel;
+
+        glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+            lightCenter.y - radius, lightCenter.y + radius,
+            -lightCenter.z - depthRange, -lightCenter.z + depthRange);
+        return projection * lightView;
+    }
+};
+
+#endif
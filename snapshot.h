@@ -0,0 +1,248 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//  : ,      - 
+//  POD-,   16 .   
+// fwrite    ,    
+// :  -    ,    .
+//   -  (little-endian    ).
+//       .
+const char SNAPSHOT_MAGIC[8] = { 'A', 'D', 'S', 'N', 'A', 'P', 0, 0 };
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+};
+
+struct SnapshotSection {
+    uint32_t id;
+    uint32_t elementSize;   // sizeof    
+    uint64_t count;
+    uint64_t offset;        //   
+};
+
+inline uint64_t snapshot_align(uint64_t value) { return (value + 15) & ~(uint64_t)15; }
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(uint32_t version) : version(version) {}
+
+    template <typename T>
+    void add(uint32_t id, const T* data, size_t count) {
+        sections.push_back({ id, (uint32_t)sizeof(T), (uint64_t)count, 0 });
+        payloads.push_back((const unsigned char*)data);
+    }
+
+    template <typename T>
+    void add(uint32_t id, const std::vector<T>& values) { add(id, values.data(), values.size()); }
+
+    template <typename T>
+    void add_value(uint32_t id, const T& value) { add(id, &value, 1); }
+
+    //           
+    bool write(const std::string& path) {
+        uint64_t offset = snapshot_align(sizeof(SnapshotHeader) + sections.size() * sizeof(SnapshotSection));
+        for (SnapshotSection& s : sections) {
+            s.offset = offset;
+            offset = snapshot_align(offset + s.count * s.elementSize);
+        }
+
+        std::vector<unsigned char> buffer((size_t)offset, 0);
+        SnapshotHeader header;
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = version;
+        header.sectionCount = (uint32_t)sections.size();
+        header.fileSize = offset;
+        memcpy(buffer.data(), &header, sizeof(header));
+        if (!sections.empty()) {
+            memcpy(buffer.data() + sizeof(SnapshotHeader), sections.data(), sections.size() * sizeof(SnapshotSection));
+        }
+        for (size_t i = 0; i < sections.size(); i++) {
+            if (sections[i].count) {
+                memcpy(buffer.data() + sections[i].offset, payloads[i], (size_t)(sections[i].count * sections[i].elementSize));
+            }
+        }
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        return fclose(file) == 0 && written;
+    }
+
+private:
+    uint32_t version;
+    std::vector<SnapshotSection> sections;
+    std::vector<const unsigned char*> payloads;
+};
+
+//     .   section()
+//   close().
+class SnapshotReader {
+public:
+    std::string error;
+
+    ~SnapshotReader() { close(); }
+
+    bool open(const std::string& path, uint32_t version) {
+        close();
+        if (!map(path)) {
+            error = "cannot map " + path;
+            return false;
+        }
+
+        if (size < sizeof(SnapshotHeader)) return fail("file is truncated");
+        const SnapshotHeader* header = (const SnapshotHeader*)data;
+        if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) return fail("not a world snapshot");
+        if (header->version != version) {
+            return fail("version " + std::to_string(header->version) + ", expected " + std::to_string(version));
+        }
+        if (header->fileSize != size) return fail("file size mismatch");
+        if (sizeof(SnapshotHeader) + (uint64_t)header->sectionCount * sizeof(SnapshotSection) > size) return fail("section table is truncated");
+
+        sections = (const SnapshotSection*)(data + sizeof(SnapshotHeader));
+        sectionCount = header->sectionCount;
+        for (uint32_t i = 0; i < sectionCount; i++) {
+            const SnapshotSection& s = sections[i];
+            // ,   : count * elementSize  
+            if (s.offset % 16 != 0 || s.offset > size || s.elementSize == 0 ||
+                s.count > (size - s.offset) / s.elementSize) {
+                return fail("section " + std::to_string(s.id) + " is out of bounds");
+            }
+        }
+        return true;
+    }
+
+    void close() {
+        unmap();
+        sections = nullptr;
+        sectionCount = 0;
+    }
+
+    //     nullptr,        
+    template <typename T>
+    const T* section(uint32_t id, size_t& count) const {
+        count = 0;
+        for (uint32_t i = 0; i < sectionCount; i++) {
+            if (sections[i].id != id) continue;
+            if (sections[i].elementSize != sizeof(T)) return nullptr;
+            count = (size_t)sections[i].count;
+            return (const T*)(data + sections[i].offset);
+        }
+        return nullptr;
+    }
+
+    //      memcpy
+    template <typename T>
+    bool read(uint32_t id, std::vector<T>& out) const {
+        size_t count;
+        const T* values = section<T>(id, count);
+        if (!values) return false;
+        out.resize(count);
+        if (count) memcpy(out.data(), values, count * sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    bool read_value(uint32_t id, T& out) const {
+        size_t count;
+        const T* value = section<T>(id, count);
+        if (!value || count != 1) return false;
+        memcpy(&out, value, sizeof(T));
+        return true;
+    }
+
+private:
+    const unsigned char* data = nullptr;
+    uint64_t size = 0;
+    const SnapshotSection* sections = nullptr;
+    uint32_t sectionCount = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+    bool fail(const std::string& message) {
+        error = message;
+        close();
+        return false;
+    }
+
+#ifdef _WIN32
+    bool map(const std::string& path) {
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            unmap();
+            return false;
+        }
+        size = (uint64_t)fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    void unmap() {
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        data = nullptr;
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+        size = 0;
+    }
+#else
+    bool map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        size = (uint64_t)info.st_size;
+        void* mapped = mmap(nullptr, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+        //    ,    
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        data = (const unsigned char*)mapped;
+        return true;
+    }
+
+    void unmap() {
+        if (data) munmap((void*)data, (size_t)size);
+        data = nullptr;
+        size = 0;
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SNOW_H
+#define SNOW_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "shaders.h"
+
+//    GPU:  glDrawArraysInstanced   ,
+//      CPU.      ,
+//      frameParams,   .
+class Snowfall {
+public:
+    int flakeCount = 200000;
+    float volumeSize = 120.0f;   //    , 
+    float flakeSize = 0.12f;     //  
+    float fallSpeed = 2.5f;      // /
+    float windDrift = 25.0f;     // /     
+    bool enabled = true;
+
+    //     : draw()   
+    bool create(unsigned int frameDataBinding) {
+        ready = false;
+        program = CreateSnowProgram();
+        if (program == 0) {
+            enabled = false;
+            return false;
+        }
+        unsigned int blockIndex = glGetUniformBlockIndex(program, "FrameData");
+        if (blockIndex == GL_INVALID_INDEX) {
+            enabled = false;
+            return false;
+        }
+        glUniformBlockBinding(program, blockIndex, frameDataBinding);
+        cameraLocation = glGetUniformLocation(program, "cameraPosition");
+        paramsLocation = glGetUniformLocation(program, "snowParams");
+        glGenVertexArrays(1, &emptyVao);
+        ready = true;
+        return true;
+    }
+
+    bool available() const { return ready; }
+
+    void destroy() {
+        glDeleteProgram(program);
+        glDeleteVertexArrays(1, &emptyVao);
+    }
+
+    //       ; FrameData  
+    void draw(const glm::vec3& cameraPosition) const {
+        if (!ready || !enabled || flakeCount <= 0) return;
+
+        glUseProgram(program);
+        glUniform3f(cameraLocation, cameraPosition.x, cameraPosition.y, cameraPosition.z);
+        glUniform4f(paramsLocation, volumeSize, flakeSize, fallSpeed, windDrift);
+        glBindVertexArray(emptyVao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, flakeCount);
+        glBindVertexArray(0);
+    }
+
+private:
+    unsigned int program = 0;
+    unsigned int emptyVao = 0;
+    int cameraLocation = -1;
+    int paramsLocation = -1;
+    bool ready = false;
+};
+
+#endif
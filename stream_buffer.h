@@ -0,0 +1,117 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+//    ,    .
+//    FRAMES :      
+// glMapBufferRange  ,      
+//  ,  GPU  .
+class StreamBuffer {
+public:
+    static const int FRAMES = 3;
+
+    unsigned int buffer = 0;
+    size_t regionSize = 0;
+    size_t alignment = 256;
+
+    //   map()
+    bool stalled = false;
+    double waitMs = 0.0;
+
+    static size_t align(size_t offset, size_t to) {
+        return (offset + to - 1) / to * to;
+    }
+
+    void create(size_t bytesPerFrame) {
+        GLint uniformAlignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+        if ((size_t)uniformAlignment > alignment) alignment = (size_t)uniformAlignment;
+
+        glGenBuffers(1, &buffer);
+        allocate(bytesPerFrame);
+    }
+
+    void destroy() {
+        for (auto& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = 0;
+        }
+        if (buffer) glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+    //       
+    size_t region_offset() const { return (size_t)frame * regionSize; }
+
+    // ,  GPU    ,   .
+    //     ,  : 
+    //   ,   ,    .
+    uint8_t* map(size_t bytes) {
+        if (bytes > regionSize) {
+            size_t size = regionSize;
+            while (size < bytes) size *= 2;
+            allocate(size);
+        }
+        wait_region();
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        void* data = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)region_offset(), (GLsizeiptr)bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!data) std::cout << "Stream buffer: glMapBufferRange failed" << std::endl;
+        return static_cast<uint8_t*>(data);
+    }
+
+    void unmap() {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        if (!glUnmapBuffer(GL_ARRAY_BUFFER)) {
+            std::cout << "Stream buffer: contents lost during unmap" << std::endl;
+        }
+    }
+
+    //    ,   
+    void end_frame() {
+        fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frame = (frame + 1) % FRAMES;
+    }
+
+private:
+    GLsync fences[FRAMES] = {};
+    int frame = 0;
+
+    void allocate(size_t bytesPerFrame) {
+        regionSize = align(bytesPerFrame, alignment);
+        for (auto& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = 0;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(regionSize * FRAMES), NULL, GL_STREAM_DRAW);
+    }
+
+    void wait_region() {
+        stalled = false;
+        waitMs = 0.0;
+        GLsync fence = fences[frame];
+        if (!fence) return;
+
+        auto start = std::chrono::steady_clock::now();
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            stalled = true;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        glDeleteSync(fence);
+        fences[frame] = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,466 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gpu_memory.h"
+#include "stb_image.h"
+
+//   . request()   id   1x1,
+//         .  GPU
+//       INITIAL_SIZE;  
+//        
+//  ,      .
+//     GL_TEXTURE_BASE_LEVEL  
+//  glTexImage2D.   -  .
+//         .
+//     .   ,
+//   ,   ,    
+//   DETAIL_KEEP_FRAMES   .
+class TextureStreamer {
+public:
+    static const int INITIAL_SIZE = 64;
+    static const int DETAIL_KEEP_FRAMES = 120;
+
+    size_t uploadBytesPerFrame = 4u << 20;
+
+    //   update()
+    size_t uploadedBytes = 0;
+    size_t residentBytes = 0;
+    size_t hostBytes = 0;       //     
+    int pendingDecodes = 0;
+
+    explicit TextureStreamer(GpuMemory& memory) : memory(memory) {}
+    ~TextureStreamer() { stop(); }
+
+    void start(unsigned threadCount = 1) {
+        //   stb_image:    
+        stbi_set_flip_vertically_on_load(true);
+        running = true;
+        for (unsigned i = 0; i < threadCount; i++) {
+            decoders.emplace_back([this]() { decode_loop(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            running = false;
+        }
+        condition.notify_all();
+        for (auto& t : decoders) t.join();
+        decoders.clear();
+    }
+
+    void destroy() {
+        stop();
+        for (auto& texture : textures) {
+            memory.untrack(GpuMemory::TEXTURE, texture->id);
+            glDeleteTextures(1, &texture->id);
+        }
+        textures.clear();
+        byPath.clear();
+        byId.clear();
+    }
+
+    //   GL-. fill -     
+    unsigned int request(const std::string& path, const std::string& owner, const unsigned char fill[3]) {
+        auto it = byPath.find(path);
+        if (it != byPath.end()) {
+            Texture& existing = *textures[it->second];
+            existing.owners += ", " + owner;
+            track(existing);
+            return existing.id;
+        }
+
+        auto texture = std::unique_ptr<Texture>(new Texture());
+        texture->path = path;
+        texture->owners = owner;
+        glGenTextures(1, &texture->id);
+        glBindTexture(GL_TEXTURE_2D, texture->id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, fill);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        texture->residentBytes = 4;
+        track(*texture);
+
+        unsigned int id = texture->id;
+        size_t index = textures.size();
+        byPath[path] = index;
+        byId[id] = index;
+        {
+            //   textures    
+            std::lock_guard<std::mutex> lock(mutex);
+            textures.push_back(std::move(texture));
+            decodeQueue.push_back(index);
+            pendingDecodes++;
+        }
+        condition.notify_one();
+        return id;
+    }
+
+    //   ()    id   
+    void request_size(unsigned int id, float screenPixels) {
+        auto it = byId.find(id);
+        if (it == byId.end()) return;
+        Texture& texture = *textures[it->second];
+        texture.screenPixels = std::max(texture.screenPixels, screenPixels);
+    }
+
+    //     GL-:  ,    
+    void update() {
+        uploadedBytes = 0;
+
+        std::vector<size_t> decoded;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.swap(decodedQueue);
+        }
+        for (size_t index : decoded) {
+            Texture& t = *textures[index];
+            if (t.ready) receive_detail(t);
+            else upload_initial(t);
+        }
+
+        // :  ,      
+        while (uploadedBytes < uploadBytesPerFrame) {
+            Texture* best = nullptr;
+            int bestDeficit = 0;
+            for (auto& t : textures) {
+                if (!t->ready) continue;
+                int deficit = t->residentBase - wanted_base(*t);
+                if (deficit > 0 && t->mips[t->residentBase - 1].empty()) {
+                    //      -   
+                    request_detail(*t);
+                    continue;
+                }
+                if (deficit > bestDeficit) {
+                    bestDeficit = deficit;
+                    best = t.get();
+                }
+            }
+            if (!best) break;
+
+            //      ,   
+            if (!memory.fits(level_bytes(*best, best->residentBase - 1))) {
+                if (!drop_level(true)) break;
+                continue;
+            }
+            upload_level(*best, best->residentBase - 1);
+        }
+
+        //   (     )
+        while (memory.totalBytes > memory.budgetBytes) {
+            if (!drop_level(false)) break;
+        }
+
+        residentBytes = 0;
+        hostBytes = 0;
+        for (auto& t : textures) {
+            if (t->ready && t->detailLoaded) release_detail(*t);
+            residentBytes += t->residentBytes;
+            if (t->ready) {
+                for (const auto& level : t->mips) hostBytes += level.size();
+            }
+            t->screenPixels = 0.0f;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingDecodes = (int)decodeQueue.size() + busyDecoders;
+    }
+
+private:
+    struct Texture {
+        std::string path;
+        std::string owners;
+        unsigned int id = 0;
+        int components = 0;      //  
+        GLenum format_gl = GL_RGB;   //  GL-
+        const char* format = "RGB8";
+        //  GL-;   initialBase ,   
+        std::vector<std::vector<unsigned char>> mips;
+        std::vector<std::vector<unsigned char>> decodedMips;   //  
+        std::vector<int> widths, heights;   //    
+        int initialBase = 0;     //     
+        int residentBase = 0;    //    
+        bool detailLoaded = false;      //     mips
+        bool detailRequested = false;   //    
+        bool detailFailed = false;
+        int detailIdleFrames = 0;
+        size_t residentBytes = 0;
+        uint64_t contentHash = 0;
+        float screenPixels = 0.0f;
+        bool ready = false;      //    GPU
+        bool failed = false;
+    };
+
+    GpuMemory& memory;
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::unordered_map<std::string, size_t> byPath;
+    std::unordered_map<unsigned int, size_t> byId;
+
+    std::vector<std::thread> decoders;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<size_t> decodeQueue;
+    std::vector<size_t> decodedQueue;
+    int busyDecoders = 0;
+    bool running = false;
+
+    //   decodedMips ,      decodedQueue
+    void decode_loop() {
+        while (true) {
+            size_t index;
+            Texture* texture;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return !running || !decodeQueue.empty(); });
+                if (!running) return;
+                index = decodeQueue.front();
+                decodeQueue.pop_front();
+                texture = textures[index].get();
+                busyDecoders++;
+            }
+
+            decode(*texture, texture->ready);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            busyDecoders--;
+            decodedQueue.push_back(index);
+        }
+    }
+
+    //   -     .  (ready 
+    //  GL-) -    initialBase, 
+    //       GL-.
+    static void decode(Texture& texture, bool detailOnly) {
+        int width, height, components;
+        unsigned char* data = stbi_load(texture.path.c_str(), &width, &height, &components, 0);
+        if (!data) {
+            if (!detailOnly) texture.failed = true;
+            return;
+        }
+        if (detailOnly && (width != texture.widths[0] || height != texture.heights[0] ||
+            components != texture.components)) {
+            //     -       
+            stbi_image_free(data);
+            return;
+        }
+
+        if (!detailOnly) texture.components = components;
+
+        std::vector<std::vector<unsigned char>>& mips = texture.decodedMips;
+        mips.emplace_back(data, data + (size_t)width * height * components);
+        if (!detailOnly) {
+            texture.widths.push_back(width);
+            texture.heights.push_back(height);
+        }
+        stbi_image_free(data);
+
+        int levels = detailOnly ? texture.initialBase : INT32_MAX;
+        while ((int)mips.size() < levels && (width > 1 || height > 1)) {
+            std::vector<unsigned char> next = mips.back();
+            downsample_half(next, width, height, components);
+            mips.push_back(std::move(next));
+            if (!detailOnly) {
+                texture.widths.push_back(width);
+                texture.heights.push_back(height);
+            }
+        }
+        if (detailOnly) return;
+
+        int base = 0;
+        while (base + 1 < (int)mips.size() &&
+            std::max(texture.widths[base], texture.heights[base]) > INITIAL_SIZE) {
+            base++;
+        }
+        texture.initialBase = base;
+    }
+
+    //  2x2
+    static void downsample_half(std::vector<unsigned char>& pixels, int& width, int& height, int components) {
+        int w = std::max(1, width / 2);
+        int h = std::max(1, height / 2);
+        std::vector<unsigned char> result((size_t)w * h * components);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                for (int c = 0; c < components; c++) {
+                    int sum = 0;
+                    for (int i = 0; i < 4; i++) {
+                        int sx = std::min(width - 1, x * 2 + (i & 1));
+                        int sy = std::min(height - 1, y * 2 + (i >> 1));
+                        sum += pixels[((size_t)sy * width + sx) * components + c];
+                    }
+                    result[((size_t)y * w + x) * components + c] = (unsigned char)(sum / 4);
+                }
+            }
+        }
+        pixels.swap(result);
+        width = w;
+        height = h;
+    }
+
+    int level_bytes(const Texture& t, int level) const {
+        // RGB    4 
+        int bytesPerPixel = t.components == 3 ? 4 : t.components;
+        return t.widths[level] * t.heights[level] * bytesPerPixel;
+    }
+
+    // ,       
+    int wanted_base(const Texture& t) const {
+        if (t.screenPixels <= 0.0f) return t.initialBase;
+        float size = (float)std::max(t.widths[0], t.heights[0]);
+        int level = (int)std::floor(std::log2(std::max(1.0f, size / t.screenPixels)));
+        return std::min(t.initialBase, std::max(0, level));
+    }
+
+    void upload_initial(Texture& t) {
+        if (t.failed) {
+            std::cout << "Texture failed to load at path: " << t.path << std::endl;
+            return;
+        }
+
+        //   ,    : track()  
+        //  GL-     
+        static const GLenum glFormats[5] = { GL_RGB, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        static const char* formatNames[5] = { "RGB8", "R8", "RG8", "RGB8", "RGBA8" };
+        t.format_gl = glFormats[t.components];
+        t.format = formatNames[t.components];
+
+        t.mips.swap(t.decodedMips);
+        t.decodedMips.clear();
+        int last = (int)t.mips.size() - 1;
+        glBindTexture(GL_TEXTURE_2D, t.id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int level = t.initialBase; level <= last; level++) {
+            glTexImage2D(GL_TEXTURE_2D, level, t.format_gl, t.widths[level], t.heights[level], 0,
+                t.format_gl, GL_UNSIGNED_BYTE, t.mips[level].data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, t.initialBase);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        t.residentBase = t.initialBase;
+        t.residentBytes = 0;
+        for (int level = t.initialBase; level <= last; level++) t.residentBytes += level_bytes(t, level);
+        t.ready = true;
+        uploadedBytes += t.residentBytes;
+
+        t.contentHash = GpuMemory::hash(t.mips[0].data(), t.mips[0].size());
+        //           
+        for (int level = 0; level < t.initialBase; level++) std::vector<unsigned char>().swap(t.mips[level]);
+        track(t);
+        std::cout << "Texture streamed in: " << t.path << " (" << t.widths[0] << "x" << t.heights[0]
+            << ", resident from " << t.widths[t.initialBase] << "x" << t.heights[t.initialBase] << ")" << std::endl;
+    }
+
+    //  GL-:      
+    void request_detail(Texture& t) {
+        if (t.detailRequested || t.detailFailed) return;
+        t.detailRequested = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decodeQueue.push_back(byId[t.id]);
+            pendingDecodes++;
+        }
+        condition.notify_one();
+    }
+
+    void receive_detail(Texture& t) {
+        t.detailRequested = false;
+        if ((int)t.decodedMips.size() < t.initialBase) {
+            std::cout << "Texture failed to reload at path: " << t.path << ", staying at "
+                << t.widths[t.residentBase] << "x" << t.heights[t.residentBase] << std::endl;
+            t.detailFailed = true;
+            t.decodedMips.clear();
+            return;
+        }
+        for (int level = 0; level < t.initialBase; level++) t.mips[level].swap(t.decodedMips[level]);
+        t.decodedMips.clear();
+        t.detailLoaded = true;
+        t.detailIdleFrames = 0;
+    }
+
+    //   ,    ,   DETAIL_KEEP_FRAMES
+    // :         
+    void release_detail(Texture& t) {
+        if (t.residentBase > wanted_base(t)) {
+            t.detailIdleFrames = 0;
+            return;
+        }
+        if (++t.detailIdleFrames < DETAIL_KEEP_FRAMES) return;
+        for (int level = 0; level < t.initialBase; level++) std::vector<unsigned char>().swap(t.mips[level]);
+        t.detailLoaded = false;
+    }
+
+    void upload_level(Texture& t, int level) {
+        glBindTexture(GL_TEXTURE_2D, t.id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, level, t.format_gl, t.widths[level], t.heights[level], 0,
+            t.format_gl, GL_UNSIGNED_BYTE, t.mips[level].data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        t.residentBase = level;
+        t.residentBytes += level_bytes(t, level);
+        uploadedBytes += level_bytes(t, level);
+        track(t);
+    }
+
+    void track(const Texture& t) {
+        memory.track(GpuMemory::TEXTURE, t.id, t.owners, t.path, t.format, t.residentBytes, t.contentHash);
+    }
+
+    //      ,     :
+    //       ,   -
+    //   . onlyExcess -    .
+    bool drop_level(bool onlyExcess) {
+        Texture* victim = nullptr;
+        int bestExcess = 0;
+        for (auto& t : textures) {
+            if (!t->ready || t->residentBase >= t->initialBase) continue;
+            int excess = wanted_base(*t) - t->residentBase;
+            if (onlyExcess && excess <= 0) continue;
+            if (!victim || excess > bestExcess || (excess == bestExcess &&
+                level_bytes(*t, t->residentBase) > level_bytes(*victim, victim->residentBase))) {
+                bestExcess = excess;
+                victim = t.get();
+            }
+        }
+        if (!victim) return false;
+
+        int level = victim->residentBase;
+        glBindTexture(GL_TEXTURE_2D, victim->id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+        glTexImage2D(GL_TEXTURE_2D, level, victim->format_gl, 0, 0, 0, victim->format_gl, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        victim->residentBase = level + 1;
+        victim->residentBytes -= level_bytes(*victim, level);
+        track(*victim);
+        return true;
+    }
+};
+
+#endif
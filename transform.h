@@ -0,0 +1,180 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+
+#include "ecs.h"
+#include "jobs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SIMD 1
+#include <emmintrin.h>
+#endif
+
+// ,    Y ()  .
+//      dirty = true.
+struct Transform {
+    glm::vec3 position;
+    float rotation;
+    glm::vec3 scale;
+    bool dirty = true;
+};
+
+#ifdef TRANSFORM_SIMD
+// sin/cos     ( Cephes,  ~1e-7)
+inline void sincos_ps(__m128 x, __m128& s, __m128& c) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    __m128 signSin = _mm_and_ps(x, signMask);
+    x = _mm_and_ps(x, absMask);
+
+    //   j,   
+    __m128 y = _mm_mul_ps(x, _mm_set1_ps(1.27323954473516f));
+    __m128i j = _mm_cvttps_epi32(y);
+    j = _mm_add_epi32(j, _mm_set1_epi32(1));
+    j = _mm_and_si128(j, _mm_set1_epi32(~1));
+    y = _mm_cvtepi32_ps(j);
+
+    __m128i jSin = _mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29);
+    __m128i jCos = _mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29);
+    __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    signSin = _mm_xor_ps(signSin, _mm_castsi128_ps(jSin));
+    __m128 signCos = _mm_castsi128_ps(jCos);
+
+    // x = ((x - y * DP1) - y * DP2) - y * DP3
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 cosPoly = _mm_set1_ps(2.443315711809948e-5f);
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+    cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+    __m128 sinPoly = _mm_set1_ps(-1.9515295891e-4f);
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm_mul_ps(_mm_mul_ps(sinPoly, z), x);
+    sinPoly = _mm_add_ps(sinPoly, x);
+
+    __m128 sinResult = _mm_or_ps(_mm_and_ps(polyMask, sinPoly), _mm_andnot_ps(polyMask, cosPoly));
+    __m128 cosResult = _mm_or_ps(_mm_and_ps(polyMask, cosPoly), _mm_andnot_ps(polyMask, sinPoly));
+
+    s = _mm_xor_ps(sinResult, signSin);
+    c = _mm_xor_ps(cosResult, signCos);
+}
+#endif
+
+//  T * Ry * S   Transform
+inline glm::mat4 transform_matrix(const Transform& t) {
+    float s = sinf(t.rotation);
+    float c = cosf(t.rotation);
+
+    glm::mat4 m;
+    m[0] = glm::vec4(c * t.scale.x, 0.0f, -s * t.scale.x, 0.0f);
+    m[1] = glm::vec4(0.0f, t.scale.y, 0.0f, 0.0f);
+    m[2] = glm::vec4(s * t.scale.z, 0.0f, c * t.scale.z, 0.0f);
+    m[3] = glm::vec4(t.position, 1.0f);
+    return m;
+}
+
+//     Transform. matrices[i] 
+// storage<Transform>().dense[i],    
+//   -.    .
+class TransformSystem {
+public:
+    std::vector<glm::mat4> matrices;
+    std::vector<Entity> owners;
+    std::vector<uint32_t> dirtySlots;
+    size_t updatedLastFrame = 0;
+
+    const glm::mat4& matrix(const ComponentArray<Transform>& transforms, Entity e) const {
+        return matrices[transforms.sparse[e.index]];
+    }
+
+    void update(ComponentArray<Transform>& transforms, JobSystem* jobs = nullptr) {
+        size_t count = transforms.size();
+        matrices.resize(count);
+        owners.resize(count, NULL_ENTITY);
+
+        //  ,      
+        //     
+        dirtySlots.clear();
+        for (size_t i = 0; i < count; i++) {
+            Transform& t = transforms.dense[i];
+            if (t.dirty || owners[i] != transforms.entities[i]) {
+                t.dirty = false;
+                owners[i] = transforms.entities[i];
+                dirtySlots.push_back((uint32_t)i);
+            }
+        }
+
+        //   4,  SIMD-     
+        if (jobs) {
+            jobs->parallel_for((uint32_t)dirtySlots.size(), 1024, [&](uint32_t begin, uint32_t end) {
+                compose(transforms, begin, end);
+            });
+        }
+        else {
+            compose(transforms, 0, dirtySlots.size());
+        }
+        updatedLastFrame = dirtySlots.size();
+    }
+
+    // M = T * Ry * S  dirtySlots[begin, end)
+    void compose(const ComponentArray<Transform>& transforms, size_t begin, size_t end) {
+        size_t i = begin;
+#ifdef TRANSFORM_SIMD
+        for (; i + 4 <= end; i += 4) {
+            const Transform& t0 = transforms.dense[dirtySlots[i]];
+            const Transform& t1 = transforms.dense[dirtySlots[i + 1]];
+            const Transform& t2 = transforms.dense[dirtySlots[i + 2]];
+            const Transform& t3 = transforms.dense[dirtySlots[i + 3]];
+
+            __m128 s, c;
+            sincos_ps(_mm_setr_ps(t0.rotation, t1.rotation, t2.rotation, t3.rotation), s, c);
+
+            __m128 sx = _mm_setr_ps(t0.scale.x, t1.scale.x, t2.scale.x, t3.scale.x);
+            __m128 sy = _mm_setr_ps(t0.scale.y, t1.scale.y, t2.scale.y, t3.scale.y);
+            __m128 sz = _mm_setr_ps(t0.scale.z, t1.scale.z, t2.scale.z, t3.scale.z);
+            __m128 zero = _mm_setzero_ps();
+
+            //    ,      
+            __m128 col0[4] = { _mm_mul_ps(c, sx), zero, _mm_sub_ps(zero, _mm_mul_ps(s, sx)), zero };
+            __m128 col1[4] = { zero, sy, zero, zero };
+            __m128 col2[4] = { _mm_mul_ps(s, sz), zero, _mm_mul_ps(c, sz), zero };
+            __m128 col3[4] = {
+                _mm_setr_ps(t0.position.x, t1.position.x, t2.position.x, t3.position.x),
+                _mm_setr_ps(t0.position.y, t1.position.y, t2.position.y, t3.position.y),
+                _mm_setr_ps(t0.position.z, t1.position.z, t2.position.z, t3.position.z),
+                _mm_set1_ps(1.0f)
+            };
+            _MM_TRANSPOSE4_PS(col0[0], col0[1], col0[2], col0[3]);
+            _MM_TRANSPOSE4_PS(col1[0], col1[1], col1[2], col1[3]);
+            _MM_TRANSPOSE4_PS(col2[0], col2[1], col2[2], col2[3]);
+            _MM_TRANSPOSE4_PS(col3[0], col3[1], col3[2], col3[3]);
+
+            for (int k = 0; k < 4; k++) {
+                float* m = &matrices[dirtySlots[i + k]][0][0];
+                _mm_storeu_ps(m, col0[k]);
+                _mm_storeu_ps(m + 4, col1[k]);
+                _mm_storeu_ps(m + 8, col2[k]);
+                _mm_storeu_ps(m + 12, col3[k]);
+            }
+        }
+#endif
+        for (; i < end; i++) {
+            matrices[dirtySlots[i]] = transform_matrix(transforms.dense[dirtySlots[i]]);
+        }
+    }
+};
+
+#endif